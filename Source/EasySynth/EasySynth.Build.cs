@@ -63,6 +63,8 @@ public class EasySynth : ModuleRules
 				"DesktopWidgets",
 				"MainFrame",
 				"PropertyEditor",
+				// Runtime material creation
+				"MaterialEditor",
 				// Image formats
 				"UEOpenExrRTTI",
 				// JSON parsing
@@ -82,5 +84,8 @@ public class EasySynth : ModuleRules
 		// Required for UEOpenExr
 		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
 		AddEngineThirdPartyPrivateStaticDependencies(Target, "UEOpenExr");
+
+		// Required for validating semantic rule regular expressions
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "ICU");
 	}
 }
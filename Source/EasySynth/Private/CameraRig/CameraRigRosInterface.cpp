@@ -188,7 +188,8 @@ FReply FCameraRigRosInterface::OnImportCameraRigClicked()
 bool FCameraRigRosInterface::ExportCameraRig(
 	const FString& OutputDir,
 	TArray<UCameraComponent*> RigCameras,
-	const FIntPoint& SensorSize)
+	const FIntPoint& SensorSize,
+	const FString& TargetName)
 {
 	FRosJsonContent RosJsonContent;
 
@@ -202,7 +203,9 @@ bool FCameraRigRosInterface::ExportCameraRig(
 	FJsonObjectConverter::UStructToJsonObjectString(RosJsonContent, JsonString);
 
 	// Save the file
-	const FString SaveFilePath = FPathUtils::CameraRigFilePath(OutputDir);
+	const FString SaveFilePath = TargetName.IsEmpty() ?
+		FPathUtils::CameraRigFilePath(OutputDir) :
+		FPathUtils::TargetCameraRigFilePath(OutputDir, TargetName);
 	if (!FFileHelper::SaveStringToFile(
 		JsonString,
 		*SaveFilePath,
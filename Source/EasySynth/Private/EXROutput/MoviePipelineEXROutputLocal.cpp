@@ -13,11 +13,16 @@
 #include "MoviePipelineOutputSetting.h"
 #include "ImageWriteQueue.h"
 #include "MoviePipeline.h"
-#include "MoviePipelineImageQuantization.h"
 #include "MoviePipelineMasterConfig.h"
 #include "IOpenExrRTTIModule.h"
 #include "Modules/ModuleManager.h"
 #include "MoviePipelineUtils.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/CoreDelegates.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "HAL/IConsoleManager.h"
 
 THIRD_PARTY_INCLUDES_START
 #include "OpenEXR/ImfChannelList.h"
@@ -25,29 +30,40 @@ THIRD_PARTY_INCLUDES_END
 
 #if WITH_UNREALEXR
 
-class FExrMemStreamOutLocal : public Imf::OStream
+/**
+ * Output stream that writes to a file as OpenEXR emits the data, so the encoded image is never held in memory.
+ * Small writes, such as header attributes, are gathered into a buffer, while whole line blocks go straight to the file.
+ * Write failures can't be reported through the exception-free interface, so they are remembered and returned by Close().
+ */
+class FExrFileStreamOutLocal : public Imf::OStream
 {
 public:
 
-	FExrMemStreamOutLocal()
-		: Imf::OStream("")
+	FExrFileStreamOutLocal(const FString& InFilename)
+		: Imf::OStream(TCHAR_TO_ANSI(*InFilename))
+		, FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*InFilename))
 		, Pos(0)
+		, bFailed(!FileHandle.IsValid())
 	{
+		Buffer.Reserve(BufferSize);
 	}
 
 	// InN must be 32bit to match the abstract interface.
 	virtual void write(const char c[/*n*/], int32 InN)
 	{
-		int64 SrcN = (int64)InN;
-		int64 DestPost = Pos + SrcN;
-		if (DestPost > Data.Num())
+		const int64 SrcN = (int64)InN;
+		if (Buffer.Num() + SrcN > BufferSize)
 		{
-			Data.AddUninitialized(DestPost - Data.Num());
+			FlushBuffer();
 		}
 
-		for (int64 i = 0; i < SrcN; ++i)
+		if (SrcN >= BufferSize)
+		{
+			WriteToFile((const uint8*)c, SrcN);
+		}
+		else
 		{
-			Data[Pos + i] = c[i];
+			Buffer.Append((const uint8*)c, SrcN);
 		}
 		Pos += SrcN;
 	}
@@ -73,14 +89,236 @@ public:
 
 	void seekp(uint64_t pos) override
 	{
+		// Buffered data belongs to the current position, so it has to land before moving away
+		FlushBuffer();
+		if (!bFailed && !FileHandle->Seek((int64)pos))
+		{
+			bFailed = true;
+		}
 		Pos = pos;
 	}
 
+	/** Writes any buffered data and closes the file. Returns false if any of the writes failed. */
+	bool Close()
+	{
+		FlushBuffer();
+		FileHandle.Reset();
+		return !bFailed;
+	}
+
+private:
 
+	void FlushBuffer()
+	{
+		if (Buffer.Num() > 0)
+		{
+			WriteToFile(Buffer.GetData(), Buffer.Num());
+			Buffer.Reset();
+		}
+	}
+
+	void WriteToFile(const uint8* InData, const int64 InSize)
+	{
+		if (!bFailed && !FileHandle->Write(InData, InSize))
+		{
+			bFailed = true;
+		}
+	}
+
+	/** Size of the buffer gathering small writes, line blocks larger than it bypass the buffer. */
+	static constexpr int64 BufferSize = 1024 * 1024;
+
+	TUniquePtr<IFileHandle> FileHandle;
+	TArray64<uint8> Buffer;
 	int64 Pos;
-	TArray64<uint8> Data;
+	bool bFailed;
 };
 
+TRACE_DECLARE_INT_COUNTER(EXRWritesInFlightLocal, TEXT("MoviePipeline/EXR/WritesInFlight"));
+TRACE_DECLARE_INT_COUNTER(EXRWritesWaitingLocal, TEXT("MoviePipeline/EXR/WritesWaiting"));
+TRACE_DECLARE_FLOAT_COUNTER(EXREncodeSecondsLocal, TEXT("MoviePipeline/EXR/EncodeSeconds"));
+
+/**
+ * Process-wide limits for EXR compression. OpenEXR compresses the line blocks of all files on its global thread pool,
+ * which is sized once here instead of every file asking for all cores, and files are encoded on a dedicated pool with one
+ * thread per concurrent write, so that concurrent image writes don't oversubscribe the machine and starve the render thread.
+ * Writes beyond the limit wait in the queue of the pool, instead of blocking threads of the shared image write queue.
+ */
+class FEXRCompressionPoolLocal
+{
+public:
+
+	static FEXRCompressionPoolLocal& Get()
+	{
+		static FEXRCompressionPoolLocal Pool;
+		return Pool;
+	}
+
+	/** Applies new pool settings. Writes that are already queued keep the previous number of concurrent writes until they finish. */
+	void Configure(const int32 InThreadCount, const int32 InMaxConcurrentWrites)
+	{
+		const int32 ThreadCount = InThreadCount > 0 ? InThreadCount : FPlatformMisc::NumberOfCores();
+		if (ThreadCount != Imf::globalThreadCount())
+		{
+			Imf::setGlobalThreadCount(ThreadCount);
+		}
+
+		// Destroying the pool would abandon the queued writes, so it is only resized once it is idle.
+		// The previous pool is destroyed outside the lock, as its threads take the lock when they finish.
+		TUniquePtr<FQueuedThreadPool> PreviousPool;
+		{
+			FScopeLock Lock(&CriticalSection);
+			const int32 MaxConcurrentWrites = FMath::Max(1, InMaxConcurrentWrites);
+			if (WritePool.IsValid() && (WritePoolThreads == MaxConcurrentWrites || NumInFlight + NumWaiting > 0))
+			{
+				return;
+			}
+			PreviousPool = MoveTemp(WritePool);
+			WritePool.Reset(FQueuedThreadPool::Allocate());
+			verify(WritePool->Create(MaxConcurrentWrites, 128 * 1024, TPri_BelowNormal, TEXT("EXRWritePool")));
+			WritePoolThreads = MaxConcurrentWrites;
+		}
+	}
+
+	/** Queues the write on the pool, it starts once fewer than the maximum number of writes are in flight. */
+	TFuture<bool> Enqueue(TUniquePtr<FEXRImageWriteTaskLocal>&& InTask)
+	{
+		FWriteWork* Work = new FWriteWork(MoveTemp(InTask));
+		TFuture<bool> Future = Work->Promise.GetFuture();
+
+		FScopeLock Lock(&CriticalSection);
+		check(WritePool.IsValid());
+		NumWaiting++;
+		TRACE_COUNTER_SET(EXRWritesWaitingLocal, NumWaiting);
+		WritePool->AddQueuedWork(Work);
+		return Future;
+	}
+
+	/** Returns whether no writes are queued or in flight. */
+	bool IsIdle()
+	{
+		FScopeLock Lock(&CriticalSection);
+		return NumInFlight + NumWaiting == 0;
+	}
+
+private:
+
+	/** A write queued on the pool, which completes the future returned by Enqueue once the file is written. */
+	class FWriteWork : public IQueuedWork
+	{
+	public:
+
+		explicit FWriteWork(TUniquePtr<FEXRImageWriteTaskLocal>&& InTask)
+			: Task(MoveTemp(InTask))
+		{
+		}
+
+		virtual void DoThreadedWork() override
+		{
+			FEXRCompressionPoolLocal::Get().BeginWrite();
+			const double StartTime = FPlatformTime::Seconds();
+			const bool bSuccess = Task->RunTask();
+			FEXRCompressionPoolLocal::Get().EndWrite(Task->Filename, FPlatformTime::Seconds() - StartTime);
+
+			Promise.SetValue(bSuccess);
+			delete this;
+		}
+
+		virtual void Abandon() override
+		{
+			Task->OnAbandoned();
+			FEXRCompressionPoolLocal::Get().AbandonWrite();
+
+			Promise.SetValue(false);
+			delete this;
+		}
+
+		TUniquePtr<FEXRImageWriteTaskLocal> Task;
+		TPromise<bool> Promise;
+	};
+
+	FEXRCompressionPoolLocal()
+		: WritePoolThreads(0)
+		, NumInFlight(0)
+		, NumWaiting(0)
+	{
+		// The pool threads have to stop before the modules they run are unloaded.
+		FCoreDelegates::OnPreExit.AddRaw(this, &FEXRCompressionPoolLocal::Shutdown);
+	}
+
+	/** Destroys the pool, abandoning the writes that haven't started and waiting for the ones in flight. */
+	void Shutdown()
+	{
+		TUniquePtr<FQueuedThreadPool> Pool;
+		{
+			FScopeLock Lock(&CriticalSection);
+			Pool = MoveTemp(WritePool);
+		}
+	}
+
+	/** Moves a queued write into the ones in flight, once a pool thread picks it up. */
+	void BeginWrite()
+	{
+		FScopeLock Lock(&CriticalSection);
+		NumWaiting--;
+		NumInFlight++;
+		TRACE_COUNTER_SET(EXRWritesWaitingLocal, NumWaiting);
+		TRACE_COUNTER_SET(EXRWritesInFlightLocal, NumInFlight);
+	}
+
+	/** Removes a write taken by BeginWrite and records how long the file took to encode. */
+	void EndWrite(const FString& InFilename, const double InEncodeSeconds)
+	{
+		int32 WritesInFlight;
+		int32 WritesWaiting;
+		{
+			FScopeLock Lock(&CriticalSection);
+			NumInFlight--;
+			WritesInFlight = NumInFlight;
+			WritesWaiting = NumWaiting;
+			TRACE_COUNTER_SET(EXRWritesInFlightLocal, NumInFlight);
+			TRACE_COUNTER_SET(EXREncodeSecondsLocal, InEncodeSeconds);
+		}
+
+		UE_LOG(LogMovieRenderPipelineIO, Verbose, TEXT("Encoded '%s' in %.3f s on %d threads. EXR writes in flight: %d, waiting: %d"),
+			*InFilename, InEncodeSeconds, Imf::globalThreadCount(), WritesInFlight, WritesWaiting);
+	}
+
+	/** Removes a queued write that the pool dropped without running it. */
+	void AbandonWrite()
+	{
+		FScopeLock Lock(&CriticalSection);
+		NumWaiting--;
+		TRACE_COUNTER_SET(EXRWritesWaitingLocal, NumWaiting);
+	}
+
+	FCriticalSection CriticalSection;
+	TUniquePtr<FQueuedThreadPool> WritePool;
+	int32 WritePoolThreads;
+	int32 NumInFlight;
+	int32 NumWaiting;
+};
+
+static Imf::Compression GetImfCompression(const EEXRCompressionFormatLocal InCompression)
+{
+	switch(InCompression)
+	{
+		case EEXRCompressionFormatLocal::None: return Imf::Compression::NO_COMPRESSION;
+		case EEXRCompressionFormatLocal::PIZ: return Imf::Compression::PIZ_COMPRESSION;
+		case EEXRCompressionFormatLocal::ZIP: return Imf::Compression::ZIP_COMPRESSION;
+		case EEXRCompressionFormatLocal::DWAA: return Imf::Compression::DWAA_COMPRESSION;
+		case EEXRCompressionFormatLocal::DWAB: return Imf::Compression::DWAB_COMPRESSION;
+		case EEXRCompressionFormatLocal::RLE: return Imf::Compression::RLE_COMPRESSION;
+		case EEXRCompressionFormatLocal::ZIPS: return Imf::Compression::ZIPS_COMPRESSION;
+		case EEXRCompressionFormatLocal::PXR24: return Imf::Compression::PXR24_COMPRESSION;
+		case EEXRCompressionFormatLocal::B44: return Imf::Compression::B44_COMPRESSION;
+		case EEXRCompressionFormatLocal::B44A: return Imf::Compression::B44A_COMPRESSION;
+		default:
+			checkNoEntry();
+	}
+	return Imf::Compression::NO_COMPRESSION;
+}
+
 bool FEXRImageWriteTaskLocal::RunTask()
 {
 	bool bSuccess = WriteToDisk();
@@ -114,22 +352,7 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 
 	if (bSuccess)
 	{
-		Imf::Compression FileCompression = Imf::Compression::NO_COMPRESSION;
-		switch(Compression)
-		{
-			case EEXRCompressionFormatLocal::None:
-				FileCompression = Imf::Compression::NO_COMPRESSION; break;
-			case EEXRCompressionFormatLocal::ZIP:
-				FileCompression = Imf::Compression::ZIP_COMPRESSION; break;
-			case EEXRCompressionFormatLocal::PIZ:
-				FileCompression = Imf::Compression::PIZ_COMPRESSION; break;
-			case EEXRCompressionFormatLocal::DWAA:
-				FileCompression = Imf::Compression::DWAA_COMPRESSION; break;
-			case EEXRCompressionFormatLocal::DWAB:
-				FileCompression = Imf::Compression::DWAB_COMPRESSION; break;
-			default:
-				checkNoEntry();
-		}
+		Imf::Compression FileCompression = GetImfCompression(Compression);
 
 		// Data Window specifies how much data is in the actual file, ie: 1920x1080
 		IMATH_NAMESPACE::Box2i DataWindow = IMATH_NAMESPACE::Box2i(IMATH_NAMESPACE::V2i(0,0), IMATH_NAMESPACE::V2i(Width - 1, Height - 1));
@@ -150,23 +373,29 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 		Imf::Header Header(DisplayWindow, DataWindow, 1, Imath::V2f(0, 0), 1, Imf::LineOrder::INCREASING_Y, FileCompression);
 
 		// If using lossy compression, specify the compression level in the header per exr spec.
+		// The DWA compressors only read it from a float attribute, so it doesn't go through the generic metadata.
 		if (FileCompression == Imf::Compression::DWAA_COMPRESSION ||
 			FileCompression == Imf::Compression::DWAB_COMPRESSION)
 		{
-			FileMetadata.Add("dwaCompressionLevel", CompressionLevel);
+			Imf::addDwaCompressionLevel(Header, CompressionLevel);
 		}
 
 		// Insert our key-value pair metadata (if any, can be an arbitrary set of key/value pairs)
 		AddFileMetadata(Header);
 
-		FExrMemStreamOutLocal OutputFile;
+		// The file is written under a temporary name and renamed once complete, so readers never see a partial frame.
+		const FString TempFilename = Filename + TEXT(".tmp");
+		FExrFileStreamOutLocal OutputFile(TempFilename);
 
 		{
 			// The FrameBuffer stores all the channels of the resulting image.
 			Imf::FrameBuffer FrameBuffer;
 
-			// If we have to quantize the data (ie: Upscale 8 bit to 16 bit) we need to store them long enough for the file to get written.
-			TArray<TUniquePtr<FImagePixelData>> QuantizedData;
+			// 8 bit layers are upscaled to 16 bit while writing, a block of scanlines at a time, instead of through a copy of the whole image.
+			TArray<FBlockConvertedLayer> ConvertedLayers;
+
+			// Channels decoded from layer colors by a channel schema are also stored until the file gets written.
+			TArray<TArray64<uint8>> ChannelData;
 
 			for (TUniquePtr<FImagePixelData>& Layer : Layers)
 			{
@@ -187,62 +416,71 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 					break;
 				}
 
-				int64 BytesWritten = 0;
+				// Layers with a channel schema are written as the decoded channels, at the precision the schema asks for.
+				const FEXRChannelSchemaLocal* ChannelSchema = LayerChannelSchemas.Find(Layer.Get());
+				if (ChannelSchema != nullptr && ChannelSchema->ChannelNames.Num() > 0 &&
+					CompressChannels(Header, FrameBuffer, Layer.Get(), *ChannelSchema, ChannelData))
+				{
+					continue;
+				}
+
 				switch (RawBitDepth)
 				{
 				case 8:
-				{
-					TUniquePtr<FImagePixelData> QuantizedPixelData = UE::MoviePipeline::QuantizeImagePixelDataToBitDepth(Layer.Get(), 16);
-					QuantizedData.Add(MoveTemp(QuantizedPixelData));
-
-					// Add an entry in the LayerNames table if needed since it matches by Layer pointer but that has changed.
-					FString LayerName = LayerNames.FindOrAdd(Layer.Get());
-					if (LayerName.Len() > 0)
-					{
-						LayerNames.Add(QuantizedData.Last().Get(), LayerName);
-					}
-
-					BytesWritten = CompressRaw<Imf::HALF>(Header, FrameBuffer, QuantizedData.Last().Get());
-				}
+					AddBlockConvertedLayer(Header, Layer.Get(), ConvertedLayers);
 					break;
 				case 16:
-					BytesWritten = CompressRaw<Imf::HALF>(Header, FrameBuffer, Layer.Get());
+					CompressRaw<Imf::HALF>(Header, FrameBuffer, Layer.Get());
 					break;
 				case 32:
-					BytesWritten = CompressRaw<Imf::FLOAT>(Header, FrameBuffer, Layer.Get());
+					CompressRaw<Imf::FLOAT>(Header, FrameBuffer, Layer.Get());
 					break;
 				default:
 					checkNoEntry();
 				}
-
-				// Reserve enough space in the output file for the whole layer so we don't keep reallocating.
-				OutputFile.Data.Reserve(BytesWritten);
 			}
 
-			// This scope ensures that IMF::Outputfile creates a complete file by closing the file when it goes out of scope.
-			// To complete the file, EXR seeks back into the file and writes the scanline offsets when the file is closed,
-			// which moves the tellp location. So file length is stored in advance for later use. The output file needs to be
-			// created after the header information is filled.
-			Imf::OutputFile ImfFile(OutputFile, Header, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+			// The scopes below ensure that the Imf file creates a complete file by closing the file when it goes out of scope.
+			// To complete the file, EXR seeks back into the file and writes the scanline or tile offsets when the file is closed,
+			// which moves the tellp location. The output file needs to be created after the header information is filled.
+			// Line blocks and tiles are written to the file as they are compressed.
+			const int32 FileNumThreads = NumThreads > 0 ? NumThreads : Imf::globalThreadCount();
 #if WITH_EDITOR
 			try
 #endif
 			{
-				ImfFile.setFrameBuffer(FrameBuffer);
-				ImfFile.writePixels(Height);
+				if (bTiled)
+				{
+					Header.setTileDescription(Imf::TileDescription(TileSize, TileSize, bMipMaps ? Imf::MIPMAP_LEVELS : Imf::ONE_LEVEL, Imf::ROUND_DOWN));
+					Imf::TiledOutputFile ImfFile(OutputFile, Header, FileNumThreads);
+					WriteTiles(ImfFile, FrameBuffer, ConvertedLayers);
+				}
+				else
+				{
+					Imf::OutputFile ImfFile(OutputFile, Header, FileNumThreads);
+					WriteScanlines(ImfFile, FrameBuffer, ConvertedLayers);
+				}
 			}
 #if WITH_EDITOR
 			catch (const IEX_NAMESPACE::BaseExc& Exception)
 			{
 				UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Caught exception: %s"), Exception.message().c_str());
+				bSuccess = false;
 			}
 #endif
 		}
 
-		// Now that the scope has closed for the Imf::OutputFile, now we can write the data to disk.
+		// Now that the scope has closed for the Imf::OutputFile, the file is complete and can replace the destination.
+		bSuccess = OutputFile.Close() && bSuccess;
 		if (bSuccess)
 		{
-			bSuccess = FFileHelper::SaveArrayToFile(OutputFile.Data, *Filename);
+			const bool bReplace = true;
+			const bool bEvenIfReadOnly = true;
+			bSuccess = IFileManager::Get().Move(*Filename, *TempFilename, bReplace, bEvenIfReadOnly);
+		}
+		if (!bSuccess)
+		{
+			IFileManager::Get().Delete(*TempFilename, false, true, true);
 		}
 	}
 
@@ -329,6 +567,10 @@ int64 FEXRImageWriteTaskLocal::CompressRaw(Imf::Header& InHeader, Imf::FrameBuff
 
 		// Insert the channel into the header with the right datatype.
 		InHeader.channels().insert(TCHAR_TO_ANSI(*ChannelName), Imf::Channel(OutputFormat));
+		if (IsPointSampled(InLayer))
+		{
+			PointSampledChannels.Add(ChannelName);
+		}
 
 		// Now insert the data for this channel. Unreal stores them interleaved.
 		InFrameBuffer.insert(TCHAR_TO_ANSI(*ChannelName),	// Name
@@ -341,6 +583,317 @@ int64 FEXRImageWriteTaskLocal::CompressRaw(Imf::Header& InHeader, Imf::FrameBuff
 	return int64(Width) * int64(Height) * NumChannels * int64(OutputFormat == 2 ? 4 : 2);
 }
 
+void FEXRImageWriteTaskLocal::WriteScanlines(Imf::OutputFile& InFile, const Imf::FrameBuffer& InFrameBuffer, TArray<FBlockConvertedLayer>& InConvertedLayers)
+{
+	if (InConvertedLayers.Num() == 0)
+	{
+		InFile.setFrameBuffer(InFrameBuffer);
+		InFile.writePixels(Height);
+		return;
+	}
+
+	// Line blocks of a block of scanlines are still compressed in parallel by the file.
+	const int32 BlockRows = GetConversionBlockRows();
+	for (int32 FirstRow = 0; FirstRow < Height; FirstRow += BlockRows)
+	{
+		const int32 NumRows = FMath::Min(BlockRows, Height - FirstRow);
+		Imf::FrameBuffer BlockFrameBuffer = InFrameBuffer;
+		for (FBlockConvertedLayer& ConvertedLayer : InConvertedLayers)
+		{
+			InsertConvertedBlock(BlockFrameBuffer, ConvertedLayer, FirstRow, NumRows);
+		}
+		InFile.setFrameBuffer(BlockFrameBuffer);
+		InFile.writePixels(NumRows);
+	}
+}
+
+/**
+ * Creates a frame buffer with the channels of the input one at half their size, averaging each 2x2 block of pixels.
+ * Integer channels and the point sampled ones hold IDs, which an average would turn into other IDs, so they keep the top left pixel of each block instead.
+ * Pixels of an odd last row or column are dropped, matching the rounding down of EXR mip level sizes.
+ */
+static Imf::FrameBuffer DownsampleFrameBuffer(const Imf::FrameBuffer& InFrameBuffer, const int32 InWidth, const int32 InHeight, const TSet<FString>& InPointSampledChannels, TArray<TArray64<uint8>>& OutPlanes)
+{
+	const int32 OutWidth = FMath::Max(1, InWidth / 2);
+	const int32 OutHeight = FMath::Max(1, InHeight / 2);
+
+	Imf::FrameBuffer OutFrameBuffer;
+	OutPlanes.Reset();
+	for (Imf::FrameBuffer::ConstIterator It = InFrameBuffer.begin(); It != InFrameBuffer.end(); ++It)
+	{
+		const Imf::Slice& InSlice = It.slice();
+		check(InSlice.type == Imf::HALF || InSlice.type == Imf::FLOAT || InSlice.type == Imf::UINT);
+		const bool bFloat = InSlice.type == Imf::FLOAT;
+		const bool bPointSampled = InSlice.type == Imf::UINT || InPointSampledChannels.Contains(ANSI_TO_TCHAR(It.name()));
+		const int64 ComponentWidth = InSlice.type == Imf::HALF ? 2 : 4;
+
+		TArray64<uint8>& Plane = OutPlanes.AddDefaulted_GetRef();
+		Plane.SetNumUninitialized(int64(OutWidth) * OutHeight * ComponentWidth);
+		uint8* PlanePtr = Plane.GetData();
+
+		ParallelFor(OutHeight, [&](int32 Y)
+		{
+			for (int32 X = 0; X < OutWidth; X++)
+			{
+				const int64 PixelIndex = int64(Y) * OutWidth + X;
+				if (bPointSampled)
+				{
+					FMemory::Memcpy(PlanePtr + PixelIndex * ComponentWidth, InSlice.base + 2 * X * InSlice.xStride + 2 * Y * InSlice.yStride, ComponentWidth);
+					continue;
+				}
+
+				float Sum = 0.0f;
+				for (int32 SampleY = 2 * Y; SampleY < FMath::Min(2 * Y + 2, InHeight); SampleY++)
+				{
+					for (int32 SampleX = 2 * X; SampleX < FMath::Min(2 * X + 2, InWidth); SampleX++)
+					{
+						const char* SamplePtr = InSlice.base + SampleX * InSlice.xStride + SampleY * InSlice.yStride;
+						Sum += bFloat ? *(const float*)SamplePtr : ((const FFloat16*)SamplePtr)->GetFloat();
+					}
+				}
+				const float Average = Sum / float((FMath::Min(2 * X + 2, InWidth) - 2 * X) * (FMath::Min(2 * Y + 2, InHeight) - 2 * Y));
+				if (bFloat)
+				{
+					((float*)PlanePtr)[PixelIndex] = Average;
+				}
+				else
+				{
+					((FFloat16*)PlanePtr)[PixelIndex] = FFloat16(Average);
+				}
+			}
+		});
+
+		OutFrameBuffer.insert(It.name(), Imf::Slice(InSlice.type, (char*)PlanePtr, ComponentWidth, ComponentWidth * OutWidth));
+	}
+
+	return OutFrameBuffer;
+}
+
+void FEXRImageWriteTaskLocal::WriteTiles(Imf::TiledOutputFile& InFile, const Imf::FrameBuffer& InFrameBuffer, TArray<FBlockConvertedLayer>& InConvertedLayers)
+{
+	// The full resolution level is written a block of tile rows at a time if 8-bit layers have to be converted block by block.
+	const int32 BlockRows = InConvertedLayers.Num() > 0 ? GetConversionBlockRows() : Height;
+	Imf::FrameBuffer BlockFrameBuffer = InFrameBuffer;
+	for (int32 FirstRow = 0; FirstRow < Height; FirstRow += BlockRows)
+	{
+		const int32 NumRows = FMath::Min(BlockRows, Height - FirstRow);
+		BlockFrameBuffer = InFrameBuffer;
+		for (FBlockConvertedLayer& ConvertedLayer : InConvertedLayers)
+		{
+			InsertConvertedBlock(BlockFrameBuffer, ConvertedLayer, FirstRow, NumRows);
+		}
+		InFile.setFrameBuffer(BlockFrameBuffer);
+		InFile.writeTiles(0, InFile.numXTiles(0) - 1, FirstRow / TileSize, (FirstRow + NumRows - 1) / TileSize, 0);
+	}
+
+	if (!bMipMaps)
+	{
+		return;
+	}
+
+	// Each mip level is downsampled from the previous one, which is kept until the next one is created. With mip levels,
+	// 8-bit layers are converted as a single block, so the last frame buffer covers the whole image.
+	TArray<TArray64<uint8>> PreviousLevelPlanes;
+	TArray<TArray64<uint8>> LevelPlanes;
+	Imf::FrameBuffer LevelFrameBuffer = BlockFrameBuffer;
+	for (int32 Level = 1; Level < InFile.numLevels(); Level++)
+	{
+		LevelFrameBuffer = DownsampleFrameBuffer(LevelFrameBuffer, InFile.levelWidth(Level - 1), InFile.levelHeight(Level - 1), PointSampledChannels, LevelPlanes);
+		PreviousLevelPlanes = MoveTemp(LevelPlanes);
+
+		InFile.setFrameBuffer(LevelFrameBuffer);
+		InFile.writeTiles(0, InFile.numXTiles(Level) - 1, 0, InFile.numYTiles(Level) - 1, Level);
+	}
+}
+
+int32 FEXRImageWriteTaskLocal::GetConversionBlockRows() const
+{
+	if (!bTiled)
+	{
+		return FMath::Min(ConversionBlockRows, Height);
+	}
+
+	// Tiled files are converted in whole rows of tiles, or at once if mip levels are downsampled from the whole image.
+	return bMipMaps ? Height : FMath::Min(TileSize, Height);
+}
+
+bool FEXRImageWriteTaskLocal::IsPointSampled(FImagePixelData* InLayer) const
+{
+	const FEXRChannelSchemaLocal* ChannelSchema = LayerChannelSchemas.Find(InLayer);
+	return ChannelSchema != nullptr && ChannelSchema->bPointSampled;
+}
+
+static FLinearColor GetPixelColor(const void* InRawData, const EImagePixelType InPixelType, const int64 InPixelIndex)
+{
+	switch (InPixelType)
+	{
+	case EImagePixelType::Color: return ((const FColor*)InRawData)[InPixelIndex].ReinterpretAsLinear();
+	case EImagePixelType::Float16: return FLinearColor(((const FFloat16Color*)InRawData)[InPixelIndex]);
+	case EImagePixelType::Float32: return ((const FLinearColor*)InRawData)[InPixelIndex];
+	default:
+		checkNoEntry();
+	}
+	return FLinearColor::Black;
+}
+
+static void DecodeChannels(const FEXRChannelSchemaLocal& InSchema, const FLinearColor& InColor, float* OutValues)
+{
+	for (int32 Channel = 0; Channel < InSchema.SourceChannels.Num(); Channel++)
+	{
+		OutValues[Channel] = InColor.Component(InSchema.SourceChannels[Channel]) * InSchema.Scale + InSchema.Offset;
+	}
+}
+
+static uint32 DecodeIntegerId(const FEXRChannelSchemaLocal& InSchema, const void* InRawData, const EImagePixelType InPixelType, const int64 InPixelIndex)
+{
+	// 8 bit colors still hold the sRGB encoded bytes, while float colors were linearized from them and have to be encoded back.
+	const FColor Color = InPixelType == EImagePixelType::Color ?
+		((const FColor*)InRawData)[InPixelIndex] :
+		GetPixelColor(InRawData, InPixelType, InPixelIndex).ToFColor(true);
+	const uint8 Bytes[] = { Color.R, Color.G, Color.B, Color.A };
+
+	uint32 Id = 0;
+	for (int32 Byte = 0; Byte < InSchema.SourceChannels.Num(); Byte++)
+	{
+		Id |= uint32(Bytes[InSchema.SourceChannels[Byte]]) << (8 * Byte);
+	}
+	return Id;
+}
+
+bool FEXRImageWriteTaskLocal::CompressChannels(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer, const FEXRChannelSchemaLocal& InSchema, TArray<TArray64<uint8>>& OutChannelData)
+{
+	// Schemas decode RGBA colors, so each written channel is one of the at most 4 rendered channels, or an ID made of up to 4 of their bytes.
+	const int32 NumChannels = InSchema.ChannelNames.Num();
+	bool bValidSchema = InLayer->GetNumChannels() == 4 && (InSchema.bIntegerId ?
+		NumChannels == 1 && InSchema.SourceChannels.Num() > 0 && InSchema.SourceChannels.Num() <= 4 :
+		NumChannels <= 4 && InSchema.SourceChannels.Num() == NumChannels);
+	for (int32 SourceChannel : InSchema.SourceChannels)
+	{
+		bValidSchema &= SourceChannel >= 0 && SourceChannel < 4;
+	}
+	if (!bValidSchema)
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Warning, TEXT("Channel schema doesn't fit the layer of '%s', writing the rendered colors instead."), *Filename);
+		return false;
+	}
+
+	void const* RawDataPtr;
+	int64 RawDataSize;
+	InLayer->GetRawData(RawDataPtr, RawDataSize);
+	const EImagePixelType PixelType = InLayer->GetType();
+
+	const Imf::PixelType OutputFormat = InSchema.bIntegerId ? Imf::UINT : (InSchema.bFullFloat ? Imf::FLOAT : Imf::HALF);
+	const int32 ComponentWidth = OutputFormat == Imf::HALF ? 2 : 4;
+
+	// Each channel is stored as a separate plane, so that no space is spent on channels that aren't written.
+	const int64 PlaneSize = int64(Width) * int64(Height) * ComponentWidth;
+	TArray64<uint8>& Planes = OutChannelData.AddDefaulted_GetRef();
+	Planes.SetNumUninitialized(PlaneSize * NumChannels);
+	uint8* PlanesPtr = Planes.GetData();
+
+	ParallelFor(Height, [&](int32 Y)
+	{
+		float Values[4];
+		for (int32 X = 0; X < Width; X++)
+		{
+			const int64 PixelIndex = int64(Y) * Width + X;
+			if (InSchema.bIntegerId)
+			{
+				((uint32*)PlanesPtr)[PixelIndex] = DecodeIntegerId(InSchema, RawDataPtr, PixelType, PixelIndex);
+				continue;
+			}
+
+			DecodeChannels(InSchema, GetPixelColor(RawDataPtr, PixelType, PixelIndex), Values);
+			for (int32 Channel = 0; Channel < NumChannels; Channel++)
+			{
+				uint8* PlanePtr = PlanesPtr + PlaneSize * Channel;
+				if (InSchema.bFullFloat)
+				{
+					((float*)PlanePtr)[PixelIndex] = Values[Channel];
+				}
+				else
+				{
+					((FFloat16*)PlanePtr)[PixelIndex] = FFloat16(Values[Channel]);
+				}
+			}
+		}
+	});
+
+	// Look up our layer name (if any).
+	const FString& LayerName = LayerNames.FindOrAdd(InLayer);
+	for (int32 Channel = 0; Channel < NumChannels; Channel++)
+	{
+		FString ChannelName = LayerName.Len() > 0 ? FString::Printf(TEXT("%s.%s"), *LayerName, *InSchema.ChannelNames[Channel]) : InSchema.ChannelNames[Channel];
+
+		InHeader.channels().insert(TCHAR_TO_ANSI(*ChannelName), Imf::Channel(OutputFormat));
+		if (InSchema.bPointSampled)
+		{
+			PointSampledChannels.Add(ChannelName);
+		}
+		InFrameBuffer.insert(TCHAR_TO_ANSI(*ChannelName),	// Name
+			Imf::Slice(OutputFormat,						// Type
+				(char*)(PlanesPtr + PlaneSize * Channel),	// Data Start of the channel plane
+				ComponentWidth,								// xStride
+				int64(Width) * ComponentWidth));			// yStride
+	}
+
+	return true;
+}
+
+void FEXRImageWriteTaskLocal::AddBlockConvertedLayer(Imf::Header& InHeader, FImagePixelData* InLayer, TArray<FBlockConvertedLayer>& OutConvertedLayers)
+{
+	check(InLayer->GetType() == EImagePixelType::Color);
+
+	FBlockConvertedLayer& ConvertedLayer = OutConvertedLayers.AddDefaulted_GetRef();
+	ConvertedLayer.Layer = InLayer;
+	ConvertedLayer.Block.SetNumUninitialized(int64(Width) * GetConversionBlockRows());
+
+	// Converted colors are stored as RGBA, whatever the order of the 8 bit color channels is.
+	const FString& LayerName = LayerNames.FindOrAdd(InLayer);
+	for (int32 Channel = 0; Channel < 4; Channel++)
+	{
+		FString ChannelName = GetChannelName(LayerName, Channel, ERGBFormat::RGBA);
+		InHeader.channels().insert(TCHAR_TO_ANSI(*ChannelName), Imf::Channel(Imf::HALF));
+		if (IsPointSampled(InLayer))
+		{
+			PointSampledChannels.Add(ChannelName);
+		}
+		ConvertedLayer.ChannelNames.Add(MoveTemp(ChannelName));
+	}
+}
+
+void FEXRImageWriteTaskLocal::InsertConvertedBlock(Imf::FrameBuffer& InFrameBuffer, FBlockConvertedLayer& InConvertedLayer, const int32 InFirstRow, const int32 InNumRows)
+{
+	void const* RawDataPtr;
+	int64 RawDataSize;
+	InConvertedLayer.Layer->GetRawData(RawDataPtr, RawDataSize);
+
+	// 8 bit colors are sRGB encoded, while EXR stores linear values.
+	const FColor* SourcePixels = (const FColor*)RawDataPtr + int64(InFirstRow) * Width;
+	FFloat16Color* BlockPixels = InConvertedLayer.Block.GetData();
+	ParallelFor(InNumRows, [&](int32 Row)
+	{
+		const int64 RowStart = int64(Row) * Width;
+		for (int32 X = 0; X < Width; X++)
+		{
+			BlockPixels[RowStart + X] = FFloat16Color(FLinearColor(SourcePixels[RowStart + X]));
+		}
+	});
+
+	// The frame buffer addresses pixels by their rows in the whole image, so the block data starts InFirstRow rows before it.
+	const int64 XStride = sizeof(FFloat16Color);
+	const int64 YStride = XStride * Width;
+	char* BlockStart = (char*)BlockPixels - YStride * InFirstRow;
+	for (int32 Channel = 0; Channel < 4; Channel++)
+	{
+		InFrameBuffer.insert(TCHAR_TO_ANSI(*InConvertedLayer.ChannelNames[Channel]),	// Name
+			Imf::Slice(Imf::HALF,														// Type
+				BlockStart + sizeof(FFloat16) * Channel,								// Data Start (offset by component to match interleave)
+				XStride,																// xStride
+				YStride));																// yStride
+	}
+}
+
 bool FEXRImageWriteTaskLocal::EnsureWritableFile()
 {
 	FString Directory = FPaths::GetPath(Filename);
@@ -355,15 +908,15 @@ bool FEXRImageWriteTaskLocal::EnsureWritableFile()
 	{
 		return true;
 	}
-	// If we're allowed to overwrite the file, and we deleted it ok, we can continue
-	else if (bOverwriteFile && FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Filename))
+	// If we're allowed to overwrite the file, it is replaced once the new one is completely written
+	else if (bOverwriteFile)
 	{
 		return true;
 	}
 	// We can't write to the file
 	else
 	{
-		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to write image to '%s'. Should Overwrite: %d - If we should have overwritten the file, we failed to delete the file. If we shouldn't have overwritten the file the file already exists so we can't replace it."), *Filename, bOverwriteFile);
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to write image to '%s'. The file already exists and we aren't allowed to overwrite it."), *Filename);
 		return false;
 	}
 }
@@ -378,17 +931,136 @@ void FEXRImageWriteTaskLocal::AddFileMetadata(Imf::Header& InHeader)
 	}
 }
 
-#endif // WITH_UNREALEXR
+/**
+ * Output stream that only counts the bytes OpenEXR emits, so encoding can be measured without touching the disk.
+ */
+class FExrCountingStreamOutLocal : public Imf::OStream
+{
+public:
 
-void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
+	FExrCountingStreamOutLocal()
+		: Imf::OStream("")
+		, Pos(0)
+		, Size(0)
+	{
+	}
+
+	virtual void write(const char c[/*n*/], int32 InN)
+	{
+		Pos += InN;
+		Size = FMath::Max(Size, Pos);
+	}
+
+	uint64_t tellp() override
+	{
+		return Pos;
+	}
+
+	void seekp(uint64_t InPos) override
+	{
+		Pos = InPos;
+	}
+
+	uint64 Pos;
+	uint64 Size;
+};
+
+/**
+ * Encodes the sample file with each supported compression and logs the encoding speed and compression ratio,
+ * using the same OpenEXR thread pool as rendered images, so the compression of a dataset can be picked on real data.
+ */
+static void BenchmarkEXRCompression(const TArray<FString>& InArgs)
 {
-	if (!bMultilayer)
+	if (InArgs.Num() < 1 || InArgs.Num() > 2)
 	{
-		// Some software doesn't support multi-layer, so in that case we fall back to the single-layer-multiple-file
-		// codepath of our parent.
-		Super::OnReceiveImageDataImpl(InMergedOutputFrame);
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Usage: EasySynth.BenchmarkEXRCompression <Path to a sample EXR file> [DWA compression level]"));
 		return;
 	}
+	const FString& Filename = InArgs[0];
+	const float DWACompressionLevel = InArgs.Num() > 1 ? FCString::Atof(*InArgs[1]) : 45.0f;
+
+#if WITH_EDITOR
+	try
+#endif
+	{
+		// Read every channel into its own plane, keeping the channel type.
+		Imf::InputFile InputFile(TCHAR_TO_ANSI(*Filename), Imf::globalThreadCount());
+		const Imath::Box2i DataWindow = InputFile.header().dataWindow();
+		const int64 Width = DataWindow.max.x - DataWindow.min.x + 1;
+		const int64 Height = DataWindow.max.y - DataWindow.min.y + 1;
+
+		Imf::FrameBuffer FrameBuffer;
+		TArray<TArray64<uint8>> Planes;
+		int64 RawSize = 0;
+		for (Imf::ChannelList::ConstIterator Channel = InputFile.header().channels().begin(); Channel != InputFile.header().channels().end(); ++Channel)
+		{
+			const int64 ComponentWidth = Channel.channel().type == Imf::HALF ? 2 : 4;
+			TArray64<uint8>& Plane = Planes.AddDefaulted_GetRef();
+			Plane.SetNumUninitialized(Width * Height * ComponentWidth);
+			RawSize += Plane.Num();
+
+			// The base pointer is offset so that the data window origin maps to the start of the plane.
+			char* Base = (char*)Plane.GetData() - (DataWindow.min.x + DataWindow.min.y * Width) * ComponentWidth;
+			FrameBuffer.insert(Channel.name(), Imf::Slice(Channel.channel().type, Base, ComponentWidth, ComponentWidth * Width));
+		}
+		InputFile.setFrameBuffer(FrameBuffer);
+		InputFile.readPixels(DataWindow.min.y, DataWindow.max.y);
+
+		UE_LOG(LogMovieRenderPipelineIO, Display, TEXT("Benchmarking EXR compression of '%s' (%lldx%lld, %d channels, %d threads):"),
+			*Filename, Width, Height, Planes.Num(), Imf::globalThreadCount());
+
+		const UEnum* CompressionEnum = StaticEnum<EEXRCompressionFormatLocal>();
+		for (int32 EnumIndex = 0; EnumIndex < CompressionEnum->NumEnums() - 1; EnumIndex++)
+		{
+			const EEXRCompressionFormatLocal Compression = (EEXRCompressionFormatLocal)CompressionEnum->GetValueByIndex(EnumIndex);
+
+			Imf::Header Header(InputFile.header().displayWindow(), DataWindow);
+			Header.channels() = InputFile.header().channels();
+			Header.compression() = GetImfCompression(Compression);
+			if (Compression == EEXRCompressionFormatLocal::DWAA || Compression == EEXRCompressionFormatLocal::DWAB)
+			{
+				Imf::addDwaCompressionLevel(Header, DWACompressionLevel);
+			}
+
+			FExrCountingStreamOutLocal Stream;
+			const double StartTime = FPlatformTime::Seconds();
+			{
+				Imf::OutputFile OutputFile(Stream, Header, Imf::globalThreadCount());
+				OutputFile.setFrameBuffer(FrameBuffer);
+				OutputFile.writePixels(Height);
+			}
+			const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, SMALL_NUMBER);
+
+			UE_LOG(LogMovieRenderPipelineIO, Display, TEXT("  %-6s %9.1f MB/s, ratio %6.2f, %lld bytes"),
+				*CompressionEnum->GetNameStringByIndex(EnumIndex),
+				RawSize / Seconds / (1024.0 * 1024.0),
+				(double)RawSize / FMath::Max<uint64>(Stream.Size, 1),
+				(int64)Stream.Size);
+		}
+	}
+#if WITH_EDITOR
+	catch (const IEX_NAMESPACE::BaseExc& Exception)
+	{
+		UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to benchmark EXR compression of '%s': %s"), *Filename, ANSI_TO_TCHAR(Exception.what()));
+	}
+#endif
+}
+
+static FAutoConsoleCommand BenchmarkEXRCompressionCommand(
+	TEXT("EasySynth.BenchmarkEXRCompression"),
+	TEXT("Encodes a sample EXR file with each compression and logs the encoding speed and compression ratio. Arguments: <Path to a sample EXR file> [DWA compression level]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkEXRCompression));
+
+#endif // WITH_UNREALEXR
+
+bool UMoviePipelineImageSequenceOutput_EXRLocal::HasFinishedProcessingImpl()
+{
+	// Files are written on the compression pool rather than the image write queue, so the queue fence alone doesn't cover them.
+	return Super::HasFinishedProcessingImpl() && FEXRCompressionPoolLocal::Get().IsIdle();
+}
+
+void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
+{
 	check(InMergedOutputFrame);
 
 	// Ensure our OpenExrRTTI module gets loaded. This needs to happen from the main thread, if it's not loaded then metadata silently fails when writing.
@@ -399,14 +1071,33 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 	UMoviePipelineOutputSetting* OutputSettings = GetPipeline()->GetPipelineMasterConfig()->FindSetting<UMoviePipelineOutputSetting>();
 	check(OutputSettings);
 
+	// All EXR writes share the compression threads, so the pool is sized by the setting instead of by each file.
+	FEXRCompressionPoolLocal::Get().Configure(CompressionThreadCount, MaxConcurrentWrites);
+
 	// EXR only supports one resolution per file, but in certain scenarios we can get layers with different resolutions. To solve this, we're
 	// going to write one exr file per image resolution. First we loop through all layers to figure out how many sizes we're dealing with.
+	// Some software doesn't support multi-layer, so in that case every render pass gets its own file instead. The files are
+	// still written by our task rather than the parent codepath, so that render passes keep their channel schemas.
 	TArray<FIntPoint> Resolutions;
+	TArray<FMoviePipelinePassIdentifier> PassIdentifiers;
 	for (TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : InMergedOutputFrame->ImageOutputData)
 	{
-		Resolutions.AddUnique(RenderPassData.Value->GetSize());
+		if (bMultilayer)
+		{
+			Resolutions.AddUnique(RenderPassData.Value->GetSize());
+		}
+		else
+		{
+			Resolutions.Add(RenderPassData.Value->GetSize());
+			PassIdentifiers.Add(RenderPassData.Key);
+		}
 	}
 
+	// The merged frame is only read by output settings, so if no other one receives it after us, the pixel data is moved into our
+	// write tasks instead of being copied on the game thread.
+	const TArray<UMoviePipelineOutputBase*> OutputContainers = GetPipeline()->GetPipelineMasterConfig()->GetOutputContainers();
+	const bool bTakeImageData = OutputContainers.Num() > 0 && OutputContainers.Last() == this;
+
 	// Then submit multiple write tasks. Layers that don't match the current resolution will be skipped until the correct iteration of the loop.
 	for (int32 Index = 0; Index < Resolutions.Num(); Index++)
 	{
@@ -424,18 +1115,18 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 
 			// If we're writing more than one render pass out, we need to ensure the file name has the format string in it so we don't
 			// overwrite the same file multiple times. Burn In overlays don't count because they get composited on top of an existing file.
-			const bool bIncludeRenderPass = false;
+			const bool bIncludeRenderPass = !bMultilayer;
 			const bool bTestFrameNumber = true;
 
 			UE::MoviePipeline::ValidateOutputFormatString(FileNameFormatString, bIncludeRenderPass, bTestFrameNumber);
 
 			// Create specific data that needs to override
 			TMap<FString, FString> FormatOverrides;
-			FormatOverrides.Add(TEXT("render_pass"), TEXT("")); // Render Passes are included inside the exr file by named layers.
+			FormatOverrides.Add(TEXT("render_pass"), bMultilayer ? TEXT("") : *PassIdentifiers[Index].Name); // Render Passes are included inside the exr file by named layers.
 			FormatOverrides.Add(TEXT("ext"), Extension);
 
 			// The logic for the ExtraTag is a little complicated. If there's only one layer (ideal situation) then it's empty.
-			if (Index == 0)
+			if (Index == 0 || !bMultilayer)
 			{
 				FormatOverrides.Add(TEXT("ExtraTag"), TEXT(""));
 			}
@@ -471,8 +1162,11 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 		TUniquePtr<FEXRImageWriteTaskLocal> MultiLayerImageTask = MakeUnique<FEXRImageWriteTaskLocal>();
 		MultiLayerImageTask->Filename = FinalFilePath;
 		MultiLayerImageTask->Compression = Compression;
-		// MultiLayerImageTask->CompressionLevel is intentionally skipped because it doesn't seem to make any practical difference
-		// so we don't expose it to the user because that will just cause confusion where the setting doesn't seem to do anything.
+		MultiLayerImageTask->CompressionLevel = DWACompressionLevel;
+		MultiLayerImageTask->NumThreads = ThreadsPerFile;
+		MultiLayerImageTask->bTiled = bTiled;
+		MultiLayerImageTask->TileSize = FMath::Max(16, TileSize);
+		MultiLayerImageTask->bMipMaps = bMipMaps;
 
 		// FinalFormatArgs.FileMetadata has been merged by ResolveFilenameFormatArgs with the FrameOutputState,
 		// but we need to convert from FString, FString (needed for BP/Python purposes) to a FStringFormatArg as
@@ -489,24 +1183,46 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 		int32 ShotIndex = 0;
 		for (TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : InMergedOutputFrame->ImageOutputData)
 		{
+			if (!RenderPassData.Value.IsValid())
+			{
+				// The data was already moved into the task of an earlier file.
+				continue;
+			}
 			if (RenderPassData.Value->GetSize() != Resolutions[Index])
 			{
 				// If this layer isn't for this resolution, don't add it to the multilayer task, a second task will be created soon.
 				continue;
 			}
+			if (!bMultilayer && RenderPassData.Key != PassIdentifiers[Index])
+			{
+				// Each render pass has its own file and task.
+				continue;
+			}
 
-			// No quantization required, just copy the data as we will move it into the image write task.
-			TUniquePtr<FImagePixelData> PixelData = RenderPassData.Value->CopyImageData();
+			// No quantization required, the data is moved into the image write task, or copied if other outputs still need it.
+			TUniquePtr<FImagePixelData> PixelData = bTakeImageData ? MoveTemp(RenderPassData.Value) : RenderPassData.Value->CopyImageData();
 
 			// If there is more than one layer, then we will prefix the layer. The first layer is not prefixed (and gets inserted as RGBA)
 			// as most programs that handle EXRs expect the main image data to be in an unnamed layer.
 			if (LayerIndex == 0)
 			{
 				// Only check the main image pass for transparent output since that's generally considered the 'preview'.
-				FImagePixelDataPayload* Payload = RenderPassData.Value->GetPayload<FImagePixelDataPayload>();
+				FImagePixelDataPayload* Payload = PixelData->GetPayload<FImagePixelDataPayload>();
 				bRequiresTransparentOutput = Payload->bRequireTransparentOutput;
 				ShotIndex = Payload->SampleState.OutputState.ShotIndex;
 				MultiLayerImageTask->OverscanPercentage = Payload->SampleState.OverscanPercentage;
+
+				// The whole file is compressed the same way, so the main image pass decides, or the compression under the empty name.
+				const FEXRCompressionLocal* PassCompression = PassCompressions.Find(RenderPassData.Key.Name);
+				if (PassCompression == nullptr)
+				{
+					PassCompression = PassCompressions.Find(FString());
+				}
+				if (PassCompression != nullptr)
+				{
+					MultiLayerImageTask->Compression = PassCompression->Format;
+					MultiLayerImageTask->CompressionLevel = PassCompression->DWACompressionLevel;
+				}
 			}
 			else
 			{
@@ -515,6 +1231,17 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 				MultiLayerImageTask->LayerNames.FindOrAdd(PixelData.Get(), RenderPassData.Key.Name);
 			}
 
+			// Passes without a schema of their own use the one under the empty name, if any.
+			const FEXRChannelSchemaLocal* ChannelSchema = PassChannelSchemas.Find(RenderPassData.Key.Name);
+			if (ChannelSchema == nullptr)
+			{
+				ChannelSchema = PassChannelSchemas.Find(FString());
+			}
+			if (ChannelSchema != nullptr && (ChannelSchema->ChannelNames.Num() > 0 || ChannelSchema->bPointSampled))
+			{
+				MultiLayerImageTask->LayerChannelSchemas.Add(PixelData.Get(), *ChannelSchema);
+			}
+
 			MultiLayerImageTask->Width = Resolutions[Index].X;
 			MultiLayerImageTask->Height = Resolutions[Index].Y;
 			MultiLayerImageTask->Layers.Add(MoveTemp(PixelData));
@@ -523,9 +1250,9 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 
 		MoviePipeline::FMoviePipelineOutputFutureData OutputData;
 		OutputData.Shot = GetPipeline()->GetActiveShotList()[ShotIndex];
-		OutputData.PassIdentifier = FMoviePipelinePassIdentifier(TEXT("")); // exrs put all the render passes internally so this resolves to a ""
+		OutputData.PassIdentifier = bMultilayer ? FMoviePipelinePassIdentifier(TEXT("")) : PassIdentifiers[Index]; // multilayer exrs put all the render passes internally so this resolves to a ""
 		OutputData.FilePath = FinalFilePath;
-		GetPipeline()->AddOutputFuture(ImageWriteQueue->Enqueue(MoveTemp(MultiLayerImageTask)), OutputData);
+		GetPipeline()->AddOutputFuture(FEXRCompressionPoolLocal::Get().Enqueue(MoveTemp(MultiLayerImageTask)), OutputData);
 
 #if WITH_EDITOR
 		GetPipeline()->AddFrameToOutputMetadata(ClipName, FinalImageSequenceFileName, InMergedOutputFrame->FrameOutputState, Extension, bRequiresTransparentOutput);
@@ -16,7 +16,10 @@ THIRD_PARTY_INCLUDES_START
 #include "OpenEXR/ImfInputFile.h"
 #include "OpenEXR/ImfOutputFile.h"
 #include "OpenEXR/ImfRgbaFile.h"
+#include "OpenEXR/ImfStandardAttributes.h"
 #include "OpenEXR/ImfStdIO.h"
+#include "OpenEXR/ImfThreading.h"
+#include "OpenEXR/ImfTiledOutputFile.h"
 THIRD_PARTY_INCLUDES_END
 #endif // WITH_UNREALEXR
 
@@ -34,7 +37,74 @@ enum class EEXRCompressionFormatLocal : uint8
 	/** Lossy DCT-based compression for RGB channels. Alpha and other channels are uncompressed. More efficient than DWAB for partial buffer access on read in 3rd party tools. */
 	DWAA,
 	/** Similar to DWAA but goes in blocks of 256 scanlines instead of 32. More efficient disk space and faster to decode than DWAA. */
-	DWAB
+	DWAB,
+	/** Run length encoding. Lossless, very fast, but only effective for images with large areas of the same color, such as semantic images. */
+	RLE,
+	/** Same as ZIP, but compresses each scanline separately. Lossless, faster to decode small regions, but compresses less. */
+	ZIPS,
+	/** Lossy for 32-bit float channels, which are rounded to 24 bits, and lossless for others. Good for depth. */
+	PXR24,
+	/** Lossy fixed rate compression of 4x4 pixel blocks of 16-bit channels. Other channels are uncompressed. Fast to decode for playback. */
+	B44,
+	/** Same as B44, but blocks of the same value are compressed further. */
+	B44A
+};
+
+/**
+ * Compression of EXR files, chosen per render pass.
+ */
+USTRUCT(BlueprintType)
+struct FEXRCompressionLocal
+{
+	GENERATED_BODY()
+
+	/** Compression method used for the files. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	EEXRCompressionFormatLocal Format = EEXRCompressionFormatLocal::PIZ;
+
+	/** Compression level of DWAA and DWAB. Higher values compress more, losing more detail. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR", meta = (ClampMin = 0))
+	float DWACompressionLevel = 45.0f;
+};
+
+/**
+ * Channels written into an EXR file for a render pass instead of its RGBA color, for passes that encode data other than colors.
+ */
+USTRUCT(BlueprintType)
+struct FEXRChannelSchemaLocal
+{
+	GENERATED_BODY()
+
+	/** Names of the written channels. No names writes the rendered color channels unchanged. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	TArray<FString> ChannelNames;
+
+	/** Index of the rendered color channel each written channel is decoded from, R being 0. At most 4 channels can be written. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	TArray<int32> SourceChannels;
+
+	/** Factor decoded values are multiplied by. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	float Scale = 1.0f;
+
+	/** Value added to decoded values after scaling. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	float Offset = 0.0f;
+
+	/** Whether channels are written as 32-bit floats instead of 16-bit halves. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	bool bFullFloat = false;
+
+	/**
+	 * Whether the source channels are the bytes of an integer ID, the lowest byte first, which is written into a single 32-bit unsigned integer channel.
+	 * Rendered colors are encoded back into the 8-bit sRGB bytes they were linearized from, so Scale and Offset are not applied.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	bool bIntegerId = false;
+
+	/** Whether mip levels keep one pixel of each 2x2 block instead of averaging them, for colors that encode IDs. Applies without channel names as well. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	bool bPointSampled = false;
 };
 
 #if WITH_UNREALEXR
@@ -51,8 +121,8 @@ public:
 	/** Compression method used for the resulting EXR files. */
 	EEXRCompressionFormatLocal Compression;
 
-	/** When using a lossy compression format, what is the base-error (CompressionLevel/100000) */
-	int32 CompressionLevel;
+	/** When using DWAA or DWAB compression, how much it compresses. Higher values lose more detail. */
+	float CompressionLevel;
 
 	/** A function to invoke on the game thread when the task has completed */
 	TFunction<void(bool)> OnCompleted;
@@ -71,14 +141,33 @@ public:
 	/** Optional. A mapping between the FImagePixelData and a name. The standard is that the default layer is nameless (at which point it would be omitted) and other layers are prefixed. */
 	TMap<FImagePixelData*, FString> LayerNames;
 
+	/** Optional. Channels written for a layer instead of its color channels. Matches by Layer pointer, same as LayerNames. */
+	TMap<FImagePixelData*, FEXRChannelSchemaLocal> LayerChannelSchemas;
+
 	/** Overscan info used to create apropriate dataWindow for EXR output. Goes from 0.0 to 1.0. */
 	float OverscanPercentage;
 
+	/** Number of line blocks compressed in parallel on the shared OpenEXR thread pool. 0 uses all of its threads. */
+	int32 NumThreads;
+
+	/** Whether the image is stored in square tiles instead of scanlines, so that readers can decompress only the region they need. */
+	bool bTiled;
+
+	/** Width and height of tiles in pixels. */
+	int32 TileSize;
+
+	/** Whether tiled files also store mip levels, each one half the size of the previous one. */
+	bool bMipMaps;
+
 	FEXRImageWriteTaskLocal()
 		: bOverwriteFile(true)
 		, Compression(EEXRCompressionFormatLocal::PIZ)
-		, CompressionLevel(45)
+		, CompressionLevel(45.0f)
 		, OverscanPercentage(0.0f)
+		, NumThreads(0)
+		, bTiled(false)
+		, TileSize(256)
+		, bMipMaps(false)
 	{}
 
 public:
@@ -88,6 +177,19 @@ public:
 
 private:
 
+	/** An 8-bit layer that is converted to half floats one block of scanlines at a time, while the file is written. */
+	struct FBlockConvertedLayer
+	{
+		/** The converted layer. */
+		FImagePixelData* Layer;
+
+		/** Names of the R, G, B and A channels in the file. */
+		TArray<FString> ChannelNames;
+
+		/** Half float colors of the scanlines currently being written. */
+		TArray64<FFloat16Color> Block;
+	};
+
 	/**
 	 * Run the task, attempting to write out the raw data using the currently specified parameters
 	 *
@@ -96,7 +198,7 @@ private:
 	bool WriteToDisk();
 
 	/**
-	 * Ensures that the desired output filename is writable, deleting an existing file if bOverwriteFile is true
+	 * Ensures that the desired output filename is writable, an existing file is only accepted if bOverwriteFile is true
 	 *
 	 * @return True if the file is writable and the task can proceed, false otherwise
 	 */
@@ -109,6 +211,38 @@ private:
 
 	template <Imf::PixelType OutputFormat>
 	int64 CompressRaw(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer);
+
+	/**
+	 * Decodes the channels of the schema from the layer colors and inserts them into the file instead of the layer colors.
+	 * The decoded channels are stored in OutChannelData, which has to outlive the file writing.
+	 *
+	 * @return false if the schema doesn't fit the layer, in which case nothing is inserted
+	 */
+	bool CompressChannels(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer, const FEXRChannelSchemaLocal& InSchema, TArray<TArray64<uint8>>& OutChannelData);
+
+	/** Writes all scanlines of the file, converting 8-bit layers a block at a time. */
+	void WriteScanlines(Imf::OutputFile& InFile, const Imf::FrameBuffer& InFrameBuffer, TArray<FBlockConvertedLayer>& InConvertedLayers);
+
+	/** Writes all tiles of the file, which compresses the tiles of a call in parallel, followed by its mip levels if needed. */
+	void WriteTiles(Imf::TiledOutputFile& InFile, const Imf::FrameBuffer& InFrameBuffer, TArray<FBlockConvertedLayer>& InConvertedLayers);
+
+	/** Returns the number of scanlines 8-bit layers are converted at once. */
+	int32 GetConversionBlockRows() const;
+
+	/** Returns whether the channel schema of the layer asks for its mip levels to be point sampled. */
+	bool IsPointSampled(FImagePixelData* InLayer) const;
+
+	/** Inserts the half float channels of an 8-bit layer into the header, its data is provided block by block through InsertConvertedBlock. */
+	void AddBlockConvertedLayer(Imf::Header& InHeader, FImagePixelData* InLayer, TArray<FBlockConvertedLayer>& OutConvertedLayers);
+
+	/** Converts the scanlines of the block and inserts them into the frame buffer, positioned so that the file reads them at their rows. */
+	void InsertConvertedBlock(Imf::FrameBuffer& InFrameBuffer, FBlockConvertedLayer& InConvertedLayer, const int32 InFirstRow, const int32 InNumRows);
+
+	/** Names of the channels whose mip levels are point sampled, besides integer channels, which always are. */
+	TSet<FString> PointSampledChannels;
+
+	/** Number of scanlines 8-bit layers of scanline files are converted at once. A multiple of the scanlines every compression method packs into a block. */
+	static constexpr int32 ConversionBlockRows = 256;
 };
 #endif // WITH_UNREALEXR
 
@@ -125,11 +259,21 @@ public:
 	{
 		OutputFormat = EImageFormat::EXR;
 		Compression = EEXRCompressionFormatLocal::PIZ;
+		DWACompressionLevel = 45.0f;
 		bMultilayer = true;
+		CompressionThreadCount = 0;
+		ThreadsPerFile = 0;
+		MaxConcurrentWrites = 2;
+		bTiled = false;
+		TileSize = 256;
+		bMipMaps = false;
 	}
 
 	virtual void OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame) override;
 
+protected:
+	virtual bool HasFinishedProcessingImpl() override;
+
 public:
 	/**
 	* Which compression method should the resulting EXR file be compressed with
@@ -137,9 +281,64 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
 	EEXRCompressionFormatLocal Compression;
 
+	/**
+	* How much DWAA and DWAB compress. Higher values compress more, losing more detail.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR", meta = (ClampMin = 0))
+	float DWACompressionLevel;
+
+	/**
+	* Compression of render passes by their names, instead of the one above. The compression under the empty name applies to passes without their own.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "EXR")
+	TMap<FString, FEXRCompressionLocal> PassCompressions;
+
 	/**
 	* Should we write all render passes to the same exr file? Not all software supports multi-layer exr files.
+	* Otherwise each render pass is written into its own file.
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
 	bool bMultilayer;
+
+	/**
+	* Number of threads compressing EXR files, shared by all EXR writes in the process. 0 uses one thread per physical core.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "EXR", meta = (ClampMin = 0))
+	int32 CompressionThreadCount;
+
+	/**
+	* Number of line blocks a single file compresses in parallel. 0 lets each file use all compression threads.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "EXR", meta = (ClampMin = 0))
+	int32 ThreadsPerFile;
+
+	/**
+	* Maximum number of EXR files encoded at once, each on a thread of its own. Further writes are queued until one of them finishes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "EXR", meta = (ClampMin = 1))
+	int32 MaxConcurrentWrites;
+
+	/**
+	* Channels written for render passes by their names, instead of the rendered colors. The schema under the empty name applies to passes without their own.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "EXR")
+	TMap<FString, FEXRChannelSchemaLocal> PassChannelSchemas;
+
+	/**
+	* Should images be stored in tiles instead of scanlines? Readers that only need a region of the image, such as random crops, then decompress only the tiles it covers.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	bool bTiled;
+
+	/**
+	* Width and height of tiles in pixels.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR", meta = (EditCondition = "bTiled", ClampMin = 16, UIMin = 16, UIMax = 1024))
+	int32 TileSize;
+
+	/**
+	* Should tiled images also store mip levels, each one half the size of the previous one?
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR", meta = (EditCondition = "bTiled"))
+	bool bMipMaps;
 };
@@ -6,6 +6,8 @@
 #include "LevelEditor.h"
 #include "ToolMenus.h"
 
+#include "TextureStyles/TextureMappingAsset.h"
+
 
 static const FName EasySynthTabName("EasySynth");
 
@@ -15,6 +17,15 @@ void FEasySynthModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 
+	// Texture mapping assets of older plugin versions are loaded by the commandlet as well
+	UTextureMappingAsset::RegisterPropertyRedirects();
+
+	// Headless rendering through the commandlet does not need any of the editor UI
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
 	FEasySynthStyle::Initialize();
 	FEasySynthStyle::ReloadTextures();
 
@@ -39,6 +50,11 @@ void FEasySynthModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
 	UToolMenus::UnRegisterStartupCallback(this);
 
 	UToolMenus::UnregisterOwner(this);
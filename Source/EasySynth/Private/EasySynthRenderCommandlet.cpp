@@ -0,0 +1,166 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "EasySynthRenderCommandlet.h"
+
+#include "CommandletHelpers.h"
+#include "FileHelpers.h"
+#include "LevelSequence.h"
+#include "Misc/App.h"
+#include "MoviePipelineInProcessExecutor.h"
+
+#include "RenderJob.h"
+#include "RendererTargets/CameraPoseExporter.h"
+#include "SequenceRenderer.h"
+#include "TextureStyles/SemanticCsvInterface.h"
+#include "TextureStyles/SemanticRuleEngine.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+UEasySynthRenderCommandlet::UEasySynthRenderCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UEasySynthRenderCommandlet::Main(const FString& Params)
+{
+	// Merge outputs of sharded jobs if requested
+	FString MergeDirectory;
+	if (FParse::Value(*Params, TEXT("merge="), MergeDirectory))
+	{
+		return MergeShards(MergeDirectory);
+	}
+
+	// Load the job file
+	FString JobFilePath;
+	if (!FParse::Value(*Params, TEXT("job="), JobFilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Job file not specified, use -job=<job.json>"), *FString(__FUNCTION__))
+		return 1;
+	}
+
+	// Commandlets don't create the renderer unless explicitly allowed, so fail before loading anything
+	if (!FApp::CanEverRender())
+	{
+		if (!FParse::Param(FCommandLine::Get(), TEXT("AllowCommandletRendering")))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering is not available, run the commandlet with -AllowCommandletRendering"),
+				*FString(__FUNCTION__))
+		}
+		else
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering is not available, remove -nullrhi from the command line"),
+				*FString(__FUNCTION__))
+		}
+		return 1;
+	}
+
+	FEasySynthRenderJob RenderJob;
+	FRendererTargetOptions RendererTargetOptions;
+	FString ErrorMessage;
+	if (!FEasySynthRenderJob::LoadFromFile(JobFilePath, RenderJob, ErrorMessage) ||
+		!RenderJob.ToRendererTargetOptions(RendererTargetOptions, ErrorMessage))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return 1;
+	}
+
+	// Load the requested map and the level sequence
+	if (!RenderJob.Map.IsEmpty() && UEditorLoadingAndSavingUtils::LoadMap(RenderJob.Map) == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load the map %s"), *FString(__FUNCTION__), *RenderJob.Map)
+		return 1;
+	}
+
+	ULevelSequence* LevelSequence = LoadObject<ULevelSequence>(nullptr, *RenderJob.Sequence);
+	if (LevelSequence == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load the level sequence %s"),
+			*FString(__FUNCTION__), *RenderJob.Sequence)
+		return 1;
+	}
+
+	// Create the texture style manager and the sequence renderer and add them to the root
+	// to avoid garbage collection while the engine is ticked
+	UTextureStyleManager* TextureStyleManager = NewObject<UTextureStyleManager>();
+	check(TextureStyleManager)
+	TextureStyleManager->AddToRoot();
+	TextureStyleManager->BindEvents();
+
+	// Use the same semantic classes on every render node
+	if (!RenderJob.SemanticClasses.IsEmpty())
+	{
+		FSemanticCsvInterface SemanticCsvInterface;
+		if (!SemanticCsvInterface.ImportSemanticClasses(RenderJob.SemanticClasses, TextureStyleManager, ErrorMessage))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+			TextureStyleManager->RemoveFromRoot();
+			return 1;
+		}
+	}
+
+	// Label level actors the same way each time the job is run
+	if (!RenderJob.SemanticRules.IsEmpty())
+	{
+		FSemanticRuleEngine SemanticRuleEngine;
+		if (!SemanticRuleEngine.LoadRules(RenderJob.SemanticRules, ErrorMessage) ||
+			!SemanticRuleEngine.ApplyRules(TextureStyleManager, ErrorMessage))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+			TextureStyleManager->RemoveFromRoot();
+			return 1;
+		}
+	}
+
+	USequenceRenderer* SequenceRenderer = NewObject<USequenceRenderer>();
+	check(SequenceRenderer)
+	SequenceRenderer->AddToRoot();
+	SequenceRenderer->SetTextureStyleManager(TextureStyleManager);
+
+	// Render the already prepared editor world inside this process, the PIE executor needs the editor UI
+	SequenceRenderer->SetExecutorClass(UMoviePipelineInProcessExecutor::StaticClass());
+
+	bool bRenderingSucceeded = false;
+	SequenceRenderer->OnRenderingFinished().AddLambda(
+		[&bRenderingSucceeded](bool bSuccess){ bRenderingSucceeded = bSuccess; });
+
+	if (SequenceRenderer->RenderSequence(
+		LevelSequence,
+		RendererTargetOptions,
+		RenderJob.OutputImageResolution,
+		RenderJob.OutputDirectory))
+	{
+		// Nothing ticks the engine inside a commandlet, so it has to be done here until the rendering finishes
+		while (SequenceRenderer->IsRendering() && !IsEngineExitRequested())
+		{
+			CommandletHelpers::TickEngine();
+		}
+	}
+
+	if (!bRenderingSucceeded)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering failed: %s"),
+			*FString(__FUNCTION__), *SequenceRenderer->GetErrorMessage())
+	}
+
+	SequenceRenderer->RemoveFromRoot();
+	TextureStyleManager->RemoveFromRoot();
+
+	return bRenderingSucceeded ? 0 : 1;
+}
+
+int32 UEasySynthRenderCommandlet::MergeShards(const FString& OutputDirectory)
+{
+	// Images of all shards already share the directory layout and are named by their sequence frame,
+	// so only the partial camera poses files need to be merged
+	if (!FCameraPoseExporter::MergePartialPoses(OutputDirectory))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not merge camera poses inside %s"),
+			*FString(__FUNCTION__), *OutputDirectory)
+		return 1;
+	}
+
+	return 0;
+}
@@ -15,4 +15,6 @@ const FString FPathUtils::WidgetStateAssetName(TEXT("WidgetStateAsset"));
 const FString FPathUtils::RenderingOutputDirName(TEXT("RenderingOutput"));
 const FString FPathUtils::CameraRigFileName(TEXT("CameraRig.json"));
 const FString FPathUtils::SemanticClassesFileName(TEXT("SemanticClasses.csv"));
+const FString FPathUtils::InstancesFileName(TEXT("Instances.csv"));
 const FString FPathUtils::CameraPosesFileName(TEXT("CameraPoses.csv"));
+const FString FPathUtils::RenderManifestFileName(TEXT("RenderManifest.csv"));
@@ -0,0 +1,159 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RenderJob.h"
+
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+
+
+bool FEasySynthRenderJob::LoadFromFile(
+	const FString& FilePath,
+	FEasySynthRenderJob& OutRenderJob,
+	FString& OutErrorMessage)
+{
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *FilePath))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Could not read the job file %s"), *FilePath);
+		return false;
+	}
+
+	return LoadFromString(JsonString, OutRenderJob, OutErrorMessage);
+}
+
+bool FEasySynthRenderJob::LoadFromString(
+	const FString& JsonString,
+	FEasySynthRenderJob& OutRenderJob,
+	FString& OutErrorMessage)
+{
+	OutRenderJob = FEasySynthRenderJob();
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(JsonString, &OutRenderJob))
+	{
+		OutErrorMessage = "Could not parse the job JSON";
+		return false;
+	}
+
+	if (OutRenderJob.Sequence.IsEmpty())
+	{
+		OutErrorMessage = "No level sequence specified by the job";
+		return false;
+	}
+
+	if (OutRenderJob.Targets.Num() == 0)
+	{
+		OutErrorMessage = "No rendering targets specified by the job";
+		return false;
+	}
+
+	if (OutRenderJob.OutputImageResolution.X <= 0 || OutRenderJob.OutputImageResolution.Y <= 0)
+	{
+		OutErrorMessage = "Output image resolution has to be positive";
+		return false;
+	}
+
+	if (OutRenderJob.ShardCount <= 0 || OutRenderJob.ShardIndex < 0 || OutRenderJob.ShardIndex >= OutRenderJob.ShardCount)
+	{
+		OutErrorMessage = "Shard index has to be inside [0, ShardCount)";
+		return false;
+	}
+
+	// A range starting after the first frame has to contain frames, instead of silently selecting all of them
+	if (OutRenderJob.FrameRangeStart < 0 || OutRenderJob.FrameRangeEnd < 0 ||
+		(OutRenderJob.FrameRangeStart > 0 && OutRenderJob.FrameRangeEnd <= OutRenderJob.FrameRangeStart))
+	{
+		OutErrorMessage = "Frame range has to satisfy 0 <= FrameRangeStart < FrameRangeEnd, or be left empty";
+		return false;
+	}
+
+	if (OutRenderJob.OutputDirectory.IsEmpty())
+	{
+		OutRenderJob.OutputDirectory = FPathUtils::DefaultRenderingOutputPath();
+	}
+
+	return true;
+}
+
+bool FEasySynthRenderJob::ToRendererTargetOptions(
+	FRendererTargetOptions& OutRendererTargetOptions,
+	FString& OutErrorMessage) const
+{
+	static const TMap<FString, FRendererTargetOptions::TargetType> TargetTypes = {
+		{ TEXT("ColorImage"), FRendererTargetOptions::COLOR_IMAGE },
+		{ TEXT("DepthImage"), FRendererTargetOptions::DEPTH_IMAGE },
+		{ TEXT("NormalImage"), FRendererTargetOptions::NORMAL_IMAGE },
+		{ TEXT("OpticalFlowImage"), FRendererTargetOptions::OPTICAL_FLOW_IMAGE },
+		{ TEXT("SemanticImage"), FRendererTargetOptions::SEMANTIC_IMAGE },
+		{ TEXT("InstanceImage"), FRendererTargetOptions::INSTANCE_IMAGE },
+	};
+	static const TMap<FString, EImageFormat> ImageFormats = {
+		{ TEXT("jpeg"), EImageFormat::JPEG },
+		{ TEXT("png"), EImageFormat::PNG },
+		{ TEXT("exr"), EImageFormat::EXR },
+	};
+
+	OutRendererTargetOptions = FRendererTargetOptions();
+
+	for (const FEasySynthRenderJobTarget& Target : Targets)
+	{
+		const FRendererTargetOptions::TargetType* TargetType = TargetTypes.Find(Target.Name);
+		if (TargetType == nullptr)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Unknown rendering target '%s'"), *Target.Name);
+			return false;
+		}
+
+		const EImageFormat* ImageFormat = ImageFormats.Find(Target.Format);
+		if (ImageFormat == nullptr)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Unknown output format '%s'"), *Target.Format);
+			return false;
+		}
+
+		OutRendererTargetOptions.SetSelectedTarget(*TargetType, true);
+		OutRendererTargetOptions.SetOutputFormat(*TargetType, *ImageFormat);
+		OutRendererTargetOptions.SetResolutionScale(*TargetType, Target.ResolutionScale);
+
+		if (!Target.Compression.IsEmpty())
+		{
+			const int64 Compression = StaticEnum<EEXRCompressionFormatLocal>()->GetValueByNameString(Target.Compression);
+			if (Compression == INDEX_NONE)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Unknown exr compression '%s'"), *Target.Compression);
+				return false;
+			}
+			if (FRendererTargetOptions::EncodesIds(*TargetType) &&
+				FRendererTargetOptions::IsLossyExrCompression(static_cast<EEXRCompressionFormatLocal>(Compression)))
+			{
+				OutErrorMessage = FString::Printf(TEXT("Lossy exr compression '%s' would alter IDs of the %s target"),
+					*Target.Compression, *Target.Name);
+				return false;
+			}
+			if (Target.CompressionLevel < 0.0f)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Invalid exr compression level %f"), Target.CompressionLevel);
+				return false;
+			}
+			OutRendererTargetOptions.SetExrCompression(
+				*TargetType, static_cast<EEXRCompressionFormatLocal>(Compression), Target.CompressionLevel);
+		}
+	}
+
+	OutRendererTargetOptions.SetExportCameraPoses(bExportCameraPoses);
+	OutRendererTargetOptions.SetSinglePassRendering(bSinglePassRendering);
+	OutRendererTargetOptions.SetTargetMajorOrder(bTargetMajorOrder);
+	OutRendererTargetOptions.SetRenderAllRigCameras(bRenderAllRigCameras);
+	OutRendererTargetOptions.SetResumeRendering(bResume);
+	OutRendererTargetOptions.SetSemanticStencilMode(bSemanticStencilMode);
+	OutRendererTargetOptions.SetShard(ShardIndex, ShardCount);
+	OutRendererTargetOptions.SetFrameRange(FrameRangeStart, FrameRangeEnd);
+	OutRendererTargetOptions.SetFrameStride(FrameStride);
+	OutRendererTargetOptions.SetMinFrameTranslation(MinFrameTranslation);
+	OutRendererTargetOptions.SetMinFrameRotation(MinFrameRotation);
+	OutRendererTargetOptions.SetDepthRangeMeters(DepthRange);
+	OutRendererTargetOptions.SetOpticalFlowScale(OpticalFlowScale);
+	OutRendererTargetOptions.SetMaxReadinessWaitSeconds(MaxReadinessWaitSeconds);
+
+	return true;
+}
@@ -0,0 +1,326 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RenderManifest.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+
+#include "PathUtils.h"
+
+
+const int FRenderManifest::ScanLookahead = 64;
+const FString FRenderManifest::HeaderLine(TEXT("camera,target,frame,file,size,hash"));
+
+bool FRenderManifest::Open(
+	const FString& Directory,
+	const int StartFrame,
+	const int EndFrame,
+	const bool bResume)
+{
+	// Hashes of the previous rendering may still be computed in the background
+	for (FPendingHash& PendingHash : PendingHashes)
+	{
+		PendingHash.Hash.Wait();
+	}
+	PendingHashes.Empty();
+
+	OutputDirectory = Directory;
+	ManifestFilePath = FPathUtils::RenderManifestFilePath(OutputDirectory, StartFrame, EndFrame);
+	Entries.Empty();
+	ExpectedOutputs.Empty();
+	UnflushedLines.Empty();
+
+	// Load manifests of all previous renderings into the directory, including other parts of the sequence,
+	// as parts rendered in parallel by different processes keep separate manifest files
+	if (bResume)
+	{
+		TArray<FString> ManifestFileNames;
+		IFileManager::Get().FindFiles(
+			ManifestFileNames, *(OutputDirectory / FPathUtils::RenderManifestFileWildcard()), true, false);
+		TArray<TPair<FString, FEntry>> LoadedEntries;
+		for (const FString& ManifestFileName : ManifestFileNames)
+		{
+			LoadManifestFile(OutputDirectory / ManifestFileName, LoadedEntries);
+		}
+
+		// Outputs that went missing, got truncated or were overwritten since need to be rendered again,
+		// hashing all of them is the most expensive part of resuming, so it is done in parallel
+		TArray<bool> ValidEntries;
+		ValidEntries.SetNumZeroed(LoadedEntries.Num());
+		ParallelFor(LoadedEntries.Num(), [&LoadedEntries, &ValidEntries, this](const int32 i)
+		{
+			const FEntry& Entry = LoadedEntries[i].Value;
+			const FString FilePath = OutputDirectory / Entry.File;
+			ValidEntries[i] =
+				IFileManager::Get().FileSize(*FilePath) == Entry.Size &&
+				LexToString(FMD5Hash::HashFile(*FilePath)).Equals(Entry.Hash, ESearchCase::IgnoreCase);
+		});
+
+		for (int i = 0; i < LoadedEntries.Num(); i++)
+		{
+			const FString& Key = LoadedEntries[i].Key;
+			const FEntry& Entry = LoadedEntries[i].Value;
+			if (ValidEntries[i] && !Entries.Contains(Key))
+			{
+				Entries.Add(Key, Entry);
+				UnflushedLines.Add(FString::Printf(TEXT("%s,%s,%lld,%s"),
+					*Key.Replace(TEXT("/"), TEXT(",")), *Entry.File, Entry.Size, *Entry.Hash));
+			}
+		}
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Resuming with %d of %d recorded outputs still valid"),
+			*FString(__FUNCTION__), Entries.Num(), LoadedEntries.Num())
+	}
+
+	// Start a fresh manifest of this rendering that contains all still valid outputs
+	TArray<FString> Lines;
+	Lines.Add(HeaderLine);
+	Lines.Append(UnflushedLines);
+	UnflushedLines.Empty();
+	if (!FFileHelper::SaveStringArrayToFile(
+		Lines,
+		*ManifestFilePath,
+		FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_None))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"),
+			*FString(__FUNCTION__), *ManifestFilePath)
+		return false;
+	}
+
+	return true;
+}
+
+void FRenderManifest::LoadManifestFile(const FString& FilePath, TArray<TPair<FString, FEntry>>& OutEntries)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Could not load the file %s"), *FString(__FUNCTION__), *FilePath)
+		return;
+	}
+
+	for (int i = 1; i < Lines.Num(); i++)
+	{
+		TArray<FString> Values;
+		Lines[i].ParseIntoArray(Values, TEXT(","), false);
+		if (Values.Num() != 6)
+		{
+			continue;
+		}
+
+		FEntry Entry;
+		Entry.File = Values[3];
+		Entry.Size = FCString::Atoi64(*Values[4]);
+		Entry.Hash = Values[5];
+		OutEntries.Emplace(EntryKey(Values[0], Values[1], FCString::Atoi(*Values[2])), Entry);
+	}
+}
+
+void FRenderManifest::ExpectOutputs(const FString& CameraName, const FString& TargetName, const TArray<int>& Frames)
+{
+	FExpectedOutputs& Outputs = ExpectedOutputs.AddDefaulted_GetRef();
+	Outputs.CameraName = CameraName;
+	Outputs.TargetName = TargetName;
+	Outputs.Frames = Frames;
+	Outputs.Frames.Sort();
+	Outputs.Recorded.Init(false, Outputs.Frames.Num());
+
+	// File time stamps can be as coarse as a second
+	const FDateTime Now = FDateTime::UtcNow();
+	Outputs.ExpectedSince = FDateTime(Now.GetTicks() - Now.GetTicks() % ETimespan::TicksPerSecond);
+}
+
+void FRenderManifest::ScanOutputs(const bool bOutputsComplete)
+{
+	for (FExpectedOutputs& Outputs : ExpectedOutputs)
+	{
+		if (!Outputs.bNameKnown && !FindOutputName(Outputs))
+		{
+			continue;
+		}
+
+		// Frames are written roughly in order, so only a few frames after the last recorded one
+		// need to be checked while rendering, which keeps the cost of a scan independent of the frame count
+		const FString TargetDir = OutputDirectory / Outputs.CameraName / Outputs.TargetName;
+		int CheckedFrames = 0;
+		for (int i = Outputs.FirstPending; i < Outputs.Frames.Num(); i++)
+		{
+			if (Outputs.Recorded[i])
+			{
+				continue;
+			}
+			if (!bOutputsComplete && CheckedFrames++ >= ScanLookahead)
+			{
+				break;
+			}
+
+			const int Frame = Outputs.Frames[i];
+			const FString FrameNumber = FString::FromInt(Frame);
+			const FString FileName = Outputs.NamePrefix +
+				FString::ChrN(FMath::Max(0, Outputs.FrameDigits - FrameNumber.Len()), TEXT('0')) + FrameNumber +
+				Outputs.NameSuffix;
+			const FString FilePath = TargetDir / FileName;
+			const int64 FileSize = IFileManager::Get().FileSize(*FilePath);
+			if (FileSize <= 0 || IFileManager::Get().GetTimeStamp(*FilePath) < Outputs.ExpectedSince)
+			{
+				continue;
+			}
+
+			// Image writers may still be filling the file, so wait until its size settles
+			if (!bOutputsComplete)
+			{
+				const int64* PreviousFileSize = Outputs.PendingFileSizes.Find(i);
+				if (PreviousFileSize == nullptr || *PreviousFileSize != FileSize)
+				{
+					Outputs.PendingFileSizes.Add(i, FileSize);
+					continue;
+				}
+			}
+			Outputs.PendingFileSizes.Remove(i);
+
+			Outputs.Recorded[i] = true;
+			RecordOutput(Outputs, Frame, FileName, FileSize);
+		}
+
+		while (Outputs.FirstPending < Outputs.Frames.Num() && Outputs.Recorded[Outputs.FirstPending])
+		{
+			Outputs.FirstPending++;
+		}
+	}
+
+	if (bOutputsComplete)
+	{
+		ExpectedOutputs.Empty();
+	}
+}
+
+bool FRenderManifest::FindOutputName(FExpectedOutputs& Outputs) const
+{
+	// Only needed until the first output is written, after that expected files are checked directly
+	const FString TargetDir = OutputDirectory / Outputs.CameraName / Outputs.TargetName;
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(TargetDir / TEXT("*")), true, false);
+
+	for (const FString& FileName : FileNames)
+	{
+		int Frame;
+		FString NamePrefix;
+		FString NameSuffix;
+		int FrameDigits;
+		if (!ParseFrame(FileName, Frame, NamePrefix, NameSuffix, FrameDigits) ||
+			Algo::BinarySearch(Outputs.Frames, Frame) == INDEX_NONE ||
+			IFileManager::Get().GetTimeStamp(*(TargetDir / FileName)) < Outputs.ExpectedSince)
+		{
+			continue;
+		}
+
+		Outputs.bNameKnown = true;
+		Outputs.NamePrefix = NamePrefix;
+		Outputs.NameSuffix = NameSuffix;
+		Outputs.FrameDigits = FrameDigits;
+		return true;
+	}
+
+	return false;
+}
+
+void FRenderManifest::RecordOutput(
+	const FExpectedOutputs& Outputs,
+	const int Frame,
+	const FString& FileName,
+	const int64 FileSize)
+{
+	const FString Key = EntryKey(Outputs.CameraName, Outputs.TargetName, Frame);
+	FEntry& Entry = Entries.Add(Key);
+	Entry.File = Outputs.CameraName / Outputs.TargetName / FileName;
+	Entry.Size = FileSize;
+
+	// Hashing large images would stall the rendering, so it is done on a worker thread
+	FPendingHash& PendingHash = PendingHashes.AddDefaulted_GetRef();
+	PendingHash.Key = Key;
+	PendingHash.LinePrefix = FString::Printf(TEXT("%s,%s,%d,%s,%lld,"),
+		*Outputs.CameraName, *Outputs.TargetName, Frame, *Entry.File, FileSize);
+	const FString FilePath = OutputDirectory / Entry.File;
+	PendingHash.Hash = Async(EAsyncExecution::ThreadPool, [FilePath]()
+	{
+		return LexToString(FMD5Hash::HashFile(*FilePath));
+	});
+}
+
+bool FRenderManifest::Contains(const FString& CameraName, const FString& TargetName, const int Frame) const
+{
+	return Entries.Contains(EntryKey(CameraName, TargetName, Frame));
+}
+
+bool FRenderManifest::Flush(const bool bWaitForHashes)
+{
+	for (int i = 0; i < PendingHashes.Num();)
+	{
+		FPendingHash& PendingHash = PendingHashes[i];
+		if (!bWaitForHashes && !PendingHash.Hash.IsReady())
+		{
+			i++;
+			continue;
+		}
+
+		const FString Hash = PendingHash.Hash.Get();
+		FEntry* Entry = Entries.Find(PendingHash.Key);
+		if (Entry != nullptr)
+		{
+			Entry->Hash = Hash;
+		}
+		UnflushedLines.Add(PendingHash.LinePrefix + Hash);
+		PendingHashes.RemoveAt(i);
+	}
+
+	if (UnflushedLines.Num() == 0)
+	{
+		return true;
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(
+		UnflushedLines,
+		*ManifestFilePath,
+		FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_Append))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"),
+			*FString(__FUNCTION__), *ManifestFilePath)
+		return false;
+	}
+
+	UnflushedLines.Empty();
+	return true;
+}
+
+bool FRenderManifest::ParseFrame(
+	const FString& FileName,
+	int& OutFrame,
+	FString& OutPrefix,
+	FString& OutSuffix,
+	int& OutFrameDigits)
+{
+	// Output file names end with the frame number, followed by the extension
+	const FString BaseName = FPaths::GetBaseFilename(FileName);
+	int DigitsStart = BaseName.Len();
+	while (DigitsStart > 0 && FChar::IsDigit(BaseName[DigitsStart - 1]))
+	{
+		DigitsStart--;
+	}
+	if (DigitsStart == BaseName.Len())
+	{
+		return false;
+	}
+
+	OutFrame = FCString::Atoi(*BaseName.Mid(DigitsStart));
+	OutPrefix = BaseName.Left(DigitsStart);
+	OutSuffix = FileName.Mid(BaseName.Len());
+	OutFrameDigits = BaseName.Len() - DigitsStart;
+	return true;
+}
@@ -0,0 +1,275 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RenderPlanner.h"
+
+#include "Algo/StableSort.h"
+
+
+const int FRenderWorkItem::AllRigCameras = -2;
+const int FRenderPlanner::JobOverheadFrames = 16;
+
+void FRenderPlanner::PlanWork(
+	const TArray<TSharedPtr<FRendererTarget>>& Targets,
+	const int RigCameraCount,
+	const bool bTargetMajorOrder,
+	const bool bAllRigCamerasPerJob,
+	const ETextureStyle CurrentTextureStyle,
+	const int StartFrame,
+	const int EndFrame,
+	TArray<FRenderWorkItem>& OutWorkItems)
+{
+	OutWorkItems.Empty();
+
+	if (bAllRigCamerasPerJob)
+	{
+		// A single job per target covers all cameras, so the target order alone decides style switches
+		for (const TSharedPtr<FRendererTarget>& Target : SortBySwitchCost(Targets, CurrentTextureStyle))
+		{
+			OutWorkItems.Add({ FRenderWorkItem::AllRigCameras, Target, StartFrame, EndFrame });
+		}
+	}
+	else if (bTargetMajorOrder)
+	{
+		// Each texture style is applied only once for the whole rendering
+		for (const TSharedPtr<FRendererTarget>& Target : SortBySwitchCost(Targets, CurrentTextureStyle))
+		{
+			for (int RigCameraId = 0; RigCameraId < RigCameraCount; RigCameraId++)
+			{
+				OutWorkItems.Add({ RigCameraId, Target, StartFrame, EndFrame });
+			}
+		}
+	}
+	else
+	{
+		// Each camera continues with the texture style the previous camera ended with
+		ETextureStyle LastTextureStyle = CurrentTextureStyle;
+		for (int RigCameraId = 0; RigCameraId < RigCameraCount; RigCameraId++)
+		{
+			for (const TSharedPtr<FRendererTarget>& Target : SortBySwitchCost(Targets, LastTextureStyle))
+			{
+				OutWorkItems.Add({ RigCameraId, Target, StartFrame, EndFrame });
+				LastTextureStyle = Target->TextureStyle();
+			}
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Planned %d work items with %d texture style switches"),
+		*FString(__FUNCTION__), OutWorkItems.Num(), CountStyleSwitches(OutWorkItems, CurrentTextureStyle))
+}
+
+void FRenderPlanner::SelectFrames(
+	const TArray<FTransform>& CameraTransforms,
+	const int StartFrame,
+	const int EndFrame,
+	const int FrameStride,
+	const float MinTranslation,
+	const float MinRotationDegrees,
+	TBitArray<>& OutSelectedFrames)
+{
+	OutSelectedFrames.Init(false, EndFrame);
+
+	const bool bCheckTranslation = MinTranslation > 0.0f;
+	const bool bCheckRotation = MinRotationDegrees > 0.0f;
+	int LastKeptFrame = INDEX_NONE;
+	for (int Frame = StartFrame; Frame < EndFrame; Frame += FMath::Max(FrameStride, 1))
+	{
+		// Keep the frame if no pose is known for it or its predecessor
+		bool bKeep = LastKeptFrame == INDEX_NONE || !CameraTransforms.IsValidIndex(Frame) ||
+			(!bCheckTranslation && !bCheckRotation);
+		if (!bKeep)
+		{
+			const FTransform& LastTransform = CameraTransforms[LastKeptFrame];
+			const FTransform& Transform = CameraTransforms[Frame];
+			bKeep =
+				(bCheckTranslation &&
+					FVector::Dist(LastTransform.GetTranslation(), Transform.GetTranslation()) > MinTranslation) ||
+				(bCheckRotation &&
+					FMath::RadiansToDegrees(LastTransform.GetRotation().AngularDistance(Transform.GetRotation())) >
+					MinRotationDegrees);
+		}
+
+		if (bKeep)
+		{
+			OutSelectedFrames[Frame] = true;
+			LastKeptFrame = CameraTransforms.IsValidIndex(Frame) ? Frame : INDEX_NONE;
+		}
+	}
+}
+
+int FRenderPlanner::SplitIntoRuns(
+	const FRenderWorkItem& WorkItem,
+	const TArray<int>& Frames,
+	TArray<FRenderWorkItem>& OutWorkItems)
+{
+	OutWorkItems.Empty();
+
+	int RunStart = 0;
+	while (RunStart < Frames.Num())
+	{
+		// Extend the run while frames keep the same distance as its first two frames
+		int RunEnd = RunStart + 1;
+		const int FrameStep = RunEnd < Frames.Num() ? Frames[RunEnd] - Frames[RunStart] : 1;
+		while (RunEnd < Frames.Num() && Frames[RunEnd] - Frames[RunEnd - 1] == FrameStep)
+		{
+			RunEnd++;
+		}
+
+		FRenderWorkItem Run = WorkItem;
+		Run.StartFrame = Frames[RunStart];
+		Run.EndFrame = Frames[RunEnd - 1] + 1;
+		Run.FrameStep = FrameStep;
+		OutWorkItems.Add(Run);
+
+		RunStart = RunEnd;
+	}
+
+	// Irregular frame selections produce many short runs, each rendered by a job that has to warm up the level,
+	// so neighboring runs are merged, cheapest first, as long as that renders fewer not provided frames
+	// than the warm-up of the saved job is worth, which keeps runs of sparse selections apart
+	struct FRunMerge
+	{
+		int AddedFrames;
+		int First;
+		int Second;
+		int FirstVersion;
+		int SecondVersion;
+	};
+	auto MergeLess = [](const FRunMerge& A, const FRunMerge& B)
+	{
+		return A.AddedFrames != B.AddedFrames ? A.AddedFrames < B.AddedFrames : A.First < B.First;
+	};
+
+	// Runs form a linked list, merged runs are removed from it and queued merges
+	// of runs changed since are skipped, based on their versions
+	const int RunCount = OutWorkItems.Num();
+	TArray<int> PreviousRuns;
+	TArray<int> NextRuns;
+	TArray<int> RunVersions;
+	for (int i = 0; i < RunCount; i++)
+	{
+		PreviousRuns.Add(i - 1);
+		NextRuns.Add(i + 1 < RunCount ? i + 1 : INDEX_NONE);
+		RunVersions.Add(0);
+	}
+	TBitArray<> MergedRuns(false, RunCount);
+
+	TArray<FRunMerge> Merges;
+	auto QueueMerge = [&OutWorkItems, &NextRuns, &RunVersions, &Merges, &MergeLess](const int First)
+	{
+		const int Second = NextRuns[First];
+		if (Second == INDEX_NONE)
+		{
+			return;
+		}
+		const FRenderWorkItem MergedRun = MergeRuns(OutWorkItems[First], OutWorkItems[Second]);
+		const int AddedFrames =
+			RunFrameCount(MergedRun) - RunFrameCount(OutWorkItems[First]) - RunFrameCount(OutWorkItems[Second]);
+		Merges.HeapPush({ AddedFrames, First, Second, RunVersions[First], RunVersions[Second] }, MergeLess);
+	};
+	for (int i = 0; i < RunCount - 1; i++)
+	{
+		QueueMerge(i);
+	}
+
+	while (Merges.Num() > 0)
+	{
+		FRunMerge Merge;
+		Merges.HeapPop(Merge, MergeLess, false);
+		if (MergedRuns[Merge.First] || MergedRuns[Merge.Second] ||
+			RunVersions[Merge.First] != Merge.FirstVersion || RunVersions[Merge.Second] != Merge.SecondVersion)
+		{
+			continue;
+		}
+		if (Merge.AddedFrames > JobOverheadFrames)
+		{
+			break;
+		}
+
+		OutWorkItems[Merge.First] = MergeRuns(OutWorkItems[Merge.First], OutWorkItems[Merge.Second]);
+		RunVersions[Merge.First]++;
+		MergedRuns[Merge.Second] = true;
+		NextRuns[Merge.First] = NextRuns[Merge.Second];
+		if (NextRuns[Merge.First] != INDEX_NONE)
+		{
+			PreviousRuns[NextRuns[Merge.First]] = Merge.First;
+		}
+
+		if (PreviousRuns[Merge.First] != INDEX_NONE)
+		{
+			QueueMerge(PreviousRuns[Merge.First]);
+		}
+		QueueMerge(Merge.First);
+	}
+
+	// Runs are merged into the earlier one, so the remaining runs keep their order
+	TArray<FRenderWorkItem> Runs;
+	for (int i = 0; i < RunCount; i++)
+	{
+		if (!MergedRuns[i])
+		{
+			Runs.Add(OutWorkItems[i]);
+		}
+	}
+	OutWorkItems = MoveTemp(Runs);
+
+	int RenderedFrames = 0;
+	for (const FRenderWorkItem& Run : OutWorkItems)
+	{
+		RenderedFrames += RunFrameCount(Run);
+	}
+	return RenderedFrames - Frames.Num();
+}
+
+FRenderWorkItem FRenderPlanner::MergeRuns(const FRenderWorkItem& First, const FRenderWorkItem& Second)
+{
+	// Frame steps of single frame runs don't constrain the merged step
+	int FrameStep = Second.StartFrame - First.StartFrame;
+	for (const FRenderWorkItem* Run : { &First, &Second })
+	{
+		if (RunFrameCount(*Run) > 1)
+		{
+			int Divisor = Run->FrameStep;
+			while (Divisor != 0)
+			{
+				const int Remainder = FrameStep % Divisor;
+				FrameStep = Divisor;
+				Divisor = Remainder;
+			}
+		}
+	}
+
+	FRenderWorkItem MergedRun = First;
+	MergedRun.EndFrame = Second.EndFrame;
+	MergedRun.FrameStep = FrameStep;
+	return MergedRun;
+}
+
+TArray<TSharedPtr<FRendererTarget>> FRenderPlanner::SortBySwitchCost(
+	const TArray<TSharedPtr<FRendererTarget>>& Targets,
+	const ETextureStyle CurrentTextureStyle)
+{
+	// Targets that need the current style cost nothing to switch to, the others
+	// are grouped by style, while keeping the user facing target order within groups
+	TArray<TSharedPtr<FRendererTarget>> SortedTargets = Targets;
+	Algo::StableSortBy(SortedTargets,
+		[CurrentTextureStyle](const TSharedPtr<FRendererTarget>& Target)
+		{
+			const ETextureStyle TextureStyle = Target->TextureStyle();
+			return TPair<bool, uint8>(TextureStyle != CurrentTextureStyle, static_cast<uint8>(TextureStyle));
+		});
+	return SortedTargets;
+}
+
+int FRenderPlanner::CountStyleSwitches(const TArray<FRenderWorkItem>& WorkItems, ETextureStyle CurrentTextureStyle)
+{
+	int StyleSwitches = 0;
+	for (const FRenderWorkItem& WorkItem : WorkItems)
+	{
+		if (WorkItem.Target->TextureStyle() != CurrentTextureStyle)
+		{
+			CurrentTextureStyle = WorkItem.Target->TextureStyle();
+			StyleSwitches++;
+		}
+	}
+	return StyleSwitches;
+}
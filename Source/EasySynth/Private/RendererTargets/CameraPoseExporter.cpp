@@ -5,15 +5,12 @@
 #include "Camera/CameraComponent.h"
 #include "EntitySystem/Interrogation/MovieSceneInterrogationLinker.h"
 #include "EntitySystem/MovieSceneEntitySystemTypes.h"
-#include "ILevelSequenceEditorToolkit.h"
-#include "ISequencer.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "LevelSequence.h"
 #include "Misc/FileHelper.h"
 #include "MovieScene.h"
 #include "MovieSceneObjectBindingID.h"
 #include "Sections/MovieSceneCameraCutSection.h"
-#include "Subsystems/AssetEditorSubsystem.h"
 #include "Tracks/MovieScene3DTransformTrack.h"
 
 
@@ -50,6 +47,11 @@ bool FCameraPoseExporter::ExportCameraPoses(
 	{
 		SaveFilePath = FPathUtils::CameraPosesFilePath(OutputDir, CameraComponent);
 	}
+	if (bPartialRange)
+	{
+		SaveFilePath = FPaths::GetPath(SaveFilePath) /
+			FPathUtils::PartialCameraPosesFileName(RangeStartFrame, RangeEndFrame);
+	}
 	if (!SavePosesToCSV(SaveFilePath))
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving camera poses to the file"), *FString(__FUNCTION__))
@@ -59,6 +61,104 @@ bool FCameraPoseExporter::ExportCameraPoses(
 	return true;
 }
 
+void FCameraPoseExporter::SetFrameRange(const int StartFrame, const int EndFrame)
+{
+	bPartialRange = true;
+	RangeStartFrame = StartFrame;
+	RangeEndFrame = EndFrame;
+}
+
+bool FCameraPoseExporter::ExtractRigPoses(ULevelSequence* LevelSequence, TArray<FTransform>& OutCameraTransforms)
+{
+	if (!SequencerWrapper.OpenSequence(LevelSequence))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Sequencer wrapper opening failed"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	const bool bAccumulateCameraOffset = false;
+	if (!ExtractCameraTransforms(bAccumulateCameraOffset))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Camera pose extraction failed"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	OutCameraTransforms = CameraTransforms;
+	return true;
+}
+
+bool FCameraPoseExporter::MergePartialPoses(const FString& Directory)
+{
+	// Find all partial files and group them by their directory
+	TArray<FString> PartialFilePaths;
+	const bool bFindFiles = true;
+	const bool bFindDirectories = false;
+	IFileManager::Get().FindFilesRecursive(
+		PartialFilePaths, *Directory, *FPathUtils::PartialCameraPosesFileWildcard(), bFindFiles, bFindDirectories);
+
+	TMap<FString, TArray<FString>> PartialFilesByDir;
+	for (const FString& PartialFilePath : PartialFilePaths)
+	{
+		PartialFilesByDir.FindOrAdd(FPaths::GetPath(PartialFilePath)).Add(PartialFilePath);
+	}
+
+	for (const TPair<FString, TArray<FString>>& Element : PartialFilesByDir)
+	{
+		// Collect pose lines from all parts, ordered by the frame id
+		FString HeaderLine;
+		TMap<int, FString> PoseLines;
+		for (const FString& PartialFilePath : Element.Value)
+		{
+			TArray<FString> Lines;
+			if (!FFileHelper::LoadFileToStringArray(Lines, *PartialFilePath) || Lines.Num() == 0)
+			{
+				UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while loading the file %s"),
+					*FString(__FUNCTION__), *PartialFilePath)
+				return false;
+			}
+
+			HeaderLine = Lines[0];
+			for (int i = 1; i < Lines.Num(); i++)
+			{
+				FString FrameId;
+				FString Pose;
+				if (Lines[i].Split(TEXT(","), &FrameId, &Pose))
+				{
+					PoseLines.Add(FCString::Atoi(*FrameId), Lines[i]);
+				}
+			}
+		}
+		PoseLines.KeySort(TLess<int>());
+
+		TArray<FString> Lines;
+		PoseLines.GenerateValueArray(Lines);
+		Lines.Insert(HeaderLine, 0);
+
+		const FString FilePath = Element.Key / FPathUtils::CameraPosesFileName;
+		if (!FFileHelper::SaveStringArrayToFile(
+			Lines,
+			*FilePath,
+			FFileHelper::EEncodingOptions::AutoDetect,
+			&IFileManager::Get(),
+			EFileWrite::FILEWRITE_None))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+			return false;
+		}
+
+		// Parts are not needed once merged
+		for (const FString& PartialFilePath : Element.Value)
+		{
+			IFileManager::Get().Delete(*PartialFilePath);
+		}
+
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Merged %d parts into %s"),
+			*FString(__FUNCTION__), Element.Value.Num(), *FilePath)
+	}
+
+	return true;
+}
+
 bool FCameraPoseExporter::ExtractCameraTransforms(const bool bAccumulateCameraOffset)
 {
 	// Get level sequence fps
@@ -79,9 +179,7 @@ bool FCameraPoseExporter::ExtractCameraTransforms(const bool bAccumulateCameraOf
 	for (auto CutSection : CutSections)
 	{
 		// Get the camera component
-		UCameraComponent* Camera = CutSection->GetFirstCamera(
-			*SequencerWrapper.GetSequencer(),
-			SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
+		UCameraComponent* Camera = SequencerWrapper.GetCutSectionCamera(CutSection);
 		if (Camera == nullptr)
 		{
 			UE_LOG(LogEasySynth, Error, TEXT("%s: Cut section camera component is null"), *FString(__FUNCTION__))
@@ -171,8 +269,16 @@ bool FCameraPoseExporter::SavePosesToCSV(const FString& FilePath)
 	TArray<FString> Lines;
 	Lines.Add("id,tx,ty,tz,qx,qy,qz,qw,t");
 
-	for (int i = 0; i < CameraTransforms.Num(); i++)
+	const int StartFrame = bPartialRange ? RangeStartFrame : 0;
+	const int EndFrame = bPartialRange ? FMath::Min(RangeEndFrame, CameraTransforms.Num()) : CameraTransforms.Num();
+	for (int i = StartFrame; i < EndFrame; i++)
 	{
+		// Timestamps stay those of the sequence frames, even if frames in between are not rendered
+		if (SelectedFrames.Num() > 0 && (i >= SelectedFrames.Num() || !SelectedFrames[i]))
+		{
+			continue;
+		}
+
 		// Remove the scaling that makes no impact on camera functionality,
 		// but my be used to scale the camera placeholder mesh as user desires
 		CameraTransforms[i].SetScale3D(FVector(1.0f, 1.0f, 1.0f));
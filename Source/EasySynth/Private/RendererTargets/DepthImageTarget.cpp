@@ -5,6 +5,7 @@
 #include "Camera/CameraComponent.h"
 #include "Materials/MaterialInstanceDynamic.h"
 
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "LevelSequence.h"
 #include "TextureStyles/TextureStyleManager.h"
 
@@ -25,22 +26,11 @@ bool FDepthImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
-	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load depth post process material"), *FString(__FUNCTION__))
-		return false;
-	}
-
-	// Create the material instance and set the range parameter
-	UMaterialInstanceDynamic* PostProcessMaterialInstance =
-		UMaterialInstanceDynamic::Create(PostProcessMaterial, nullptr);
+	UMaterialInterface* PostProcessMaterialInstance = CreatePostProcessMaterial();
 	if (PostProcessMaterialInstance == nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
 		return false;
 	}
-	PostProcessMaterialInstance->SetScalarParameterValue(*DepthRangeMetersParameter, DepthRangeMeters);
 
 	for (UCameraComponent* Camera : Cameras)
 	{
@@ -56,6 +46,38 @@ bool FDepthImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
+UMaterialInterface* FDepthImageTarget::CreatePostProcessMaterial(UObject* Outer, const FName ObjectName)
+{
+	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
+	if (PostProcessMaterial == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load depth post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+
+	// Create the material instance and set the range parameter
+	UMaterialInstanceDynamic* PostProcessMaterialInstance =
+		UMaterialInstanceDynamic::Create(PostProcessMaterial, Outer, ObjectName);
+	if (PostProcessMaterialInstance == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	PostProcessMaterialInstance->SetScalarParameterValue(*DepthRangeMetersParameter, DepthRangeMeters);
+
+	return PostProcessMaterialInstance;
+}
+
+FEXRChannelSchemaLocal FDepthImageTarget::ExrChannelSchema() const
+{
+	// All color channels carry the same depth, so only one of them is written
+	FEXRChannelSchemaLocal ChannelSchema;
+	ChannelSchema.ChannelNames = { TEXT("Z") };
+	ChannelSchema.SourceChannels = { 0 };
+	ChannelSchema.bFullFloat = true;
+	return ChannelSchema;
+}
+
 bool FDepthImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
 {
 	return ClearCameraPostProcess(LevelSequence);
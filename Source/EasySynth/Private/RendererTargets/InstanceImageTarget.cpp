@@ -0,0 +1,71 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RendererTargets/InstanceImageTarget.h"
+
+#include "Camera/CameraComponent.h"
+
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "LevelSequence.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+bool FInstanceImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+{
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// Get all camera components bound to the level sequence
+	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	if (Cameras.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Prepare the camera post process material
+	UMaterialInterface* PostProcessMaterial = CreatePostProcessMaterial();
+	if (PostProcessMaterial == nullptr)
+	{
+		return false;
+	}
+
+	for (UCameraComponent* Camera : Cameras)
+	{
+		if (Camera == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Found camera is null"), *FString(__FUNCTION__))
+			return false;
+		}
+		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, PostProcessMaterial));
+	}
+
+	return true;
+}
+
+UMaterialInterface* FInstanceImageTarget::CreatePostProcessMaterial(UObject* Outer, const FName ObjectName)
+{
+	// Instance colors are displayed by actor materials the same way as semantic class colors
+	UMaterial* PostProcessMaterial = DuplicateObject<UMaterial>(
+		LoadObject<UMaterial>(nullptr, *FPathUtils::PostProcessMaterialPath(TEXT("SemanticImage"))), Outer, ObjectName);
+	if (PostProcessMaterial == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load instance post process material"), *FString(__FUNCTION__))
+	}
+	return PostProcessMaterial;
+}
+
+FEXRChannelSchemaLocal FInstanceImageTarget::ExrChannelSchema() const
+{
+	// Colors are linearized from the bytes of the ID, which readers would otherwise have to encode back
+	FEXRChannelSchemaLocal ChannelSchema;
+	ChannelSchema.ChannelNames = { TEXT("id") };
+	ChannelSchema.SourceChannels = { 0, 1, 2 };
+	ChannelSchema.bIntegerId = true;
+	return ChannelSchema;
+}
+
+bool FInstanceImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+{
+	return ClearCameraPostProcess(LevelSequence);
+}
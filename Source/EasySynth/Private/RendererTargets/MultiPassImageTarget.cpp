@@ -0,0 +1,107 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RendererTargets/MultiPassImageTarget.h"
+
+#include "Materials/MaterialInterface.h"
+#include "UObject/Package.h"
+
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "LevelSequence.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+FString FMultiPassImageTarget::Name() const
+{
+	TArray<FString> TargetNames;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		TargetNames.Add(Target->Name());
+	}
+	return FString::Join(TargetNames, TEXT("+"));
+}
+
+TArray<FString> FMultiPassImageTarget::OutputNames() const
+{
+	TArray<FString> Names;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		Names.Append(Target->OutputNames());
+	}
+	return Names;
+}
+
+TMap<FString, FEXRChannelSchemaLocal> FMultiPassImageTarget::ExrPassChannelSchemas() const
+{
+	// Passes are named after their targets, same as their materials
+	TMap<FString, FEXRChannelSchemaLocal> ChannelSchemas;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		ChannelSchemas.Add(Target->Name(), Target->ExrChannelSchema());
+	}
+	return ChannelSchemas;
+}
+
+TMap<FString, FEXRCompressionLocal> FMultiPassImageTarget::ExrPassCompressions() const
+{
+	TMap<FString, FEXRCompressionLocal> Compressions;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		const TMap<FString, FEXRCompressionLocal> TargetCompressions = Target->ExrPassCompressions();
+		const FEXRCompressionLocal* Compression = TargetCompressions.Find(FString());
+		if (Compression != nullptr)
+		{
+			Compressions.Add(Target->Name(), *Compression);
+		}
+	}
+	return Compressions;
+}
+
+bool FMultiPassImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+{
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// The main pass is not rendered, so camera post process materials are not needed
+	if (!ClearCameraPostProcess(LevelSequence))
+	{
+		return false;
+	}
+
+	// Movie pipeline names additional passes after their materials, so materials are named after targets,
+	// which requires a fresh outer for each rendering to avoid name collisions with the previous one
+	ReleasePassMaterials();
+	UPackage* PassPackage = CreatePackage(
+		*MakeUniqueObjectName(nullptr, UPackage::StaticClass(), TEXT("/Temp/EasySynthRenderPasses")).ToString());
+	PassPackage->SetFlags(RF_Transient);
+
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		UMaterialInterface* PassMaterial = Target->CreatePostProcessMaterial(PassPackage, FName(*Target->Name()));
+		if (PassMaterial == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the %s pass material"),
+				*FString(__FUNCTION__), *Target->Name())
+			ReleasePassMaterials();
+			return false;
+		}
+		PassMaterial->AddToRoot();
+		Materials.Add(PassMaterial);
+	}
+
+	return true;
+}
+
+bool FMultiPassImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+{
+	ReleasePassMaterials();
+	return ClearCameraPostProcess(LevelSequence);
+}
+
+void FMultiPassImageTarget::ReleasePassMaterials()
+{
+	for (UMaterialInterface* PassMaterial : Materials)
+	{
+		PassMaterial->RemoveFromRoot();
+	}
+	Materials.Empty();
+}
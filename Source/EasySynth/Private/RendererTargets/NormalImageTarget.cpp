@@ -4,6 +4,7 @@
 
 #include "Camera/CameraComponent.h"
 
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "LevelSequence.h"
 #include "TextureStyles/TextureStyleManager.h"
 
@@ -43,6 +44,17 @@ bool FNormalImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
+FEXRChannelSchemaLocal FNormalImageTarget::ExrChannelSchema() const
+{
+	// Colors hold normals mapped from [-1, 1] to [0, 1]
+	FEXRChannelSchemaLocal ChannelSchema;
+	ChannelSchema.ChannelNames = { TEXT("x"), TEXT("y"), TEXT("z") };
+	ChannelSchema.SourceChannels = { 0, 1, 2 };
+	ChannelSchema.Scale = 2.0f;
+	ChannelSchema.Offset = -1.0f;
+	return ChannelSchema;
+}
+
 bool FNormalImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
 {
 	return ClearCameraPostProcess(LevelSequence);
@@ -3,8 +3,16 @@
 #include "RendererTargets/OpticalFlowImageTarget.h"
 
 #include "Camera/CameraComponent.h"
+#include "MaterialEditingLibrary.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionComponentMask.h"
+#include "Materials/MaterialExpressionCustom.h"
+#include "Materials/MaterialExpressionSceneTexture.h"
+#include "Materials/MaterialExpressionScreenPosition.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "UObject/Package.h"
 
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "LevelSequence.h"
 #include "TextureStyles/TextureStyleManager.h"
 
@@ -25,22 +33,11 @@ bool FOpticalFlowImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
-	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load optical flow post process material"), *FString(__FUNCTION__))
-		return false;
-	}
-
-	// Create the material instance and set the scale parameter
-	UMaterialInstanceDynamic* PostProcessMaterialInstance =
-		UMaterialInstanceDynamic::Create(PostProcessMaterial, nullptr);
+	UMaterialInterface* PostProcessMaterialInstance = CreatePostProcessMaterial();
 	if (PostProcessMaterialInstance == nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
 		return false;
 	}
-	PostProcessMaterialInstance->SetScalarParameterValue(*OpticalFlowScaleParameter, OpticalFlowScale);
 
 	for (UCameraComponent* Camera : Cameras)
 	{
@@ -56,6 +53,91 @@ bool FOpticalFlowImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
+UMaterialInterface* FOpticalFlowImageTarget::CreatePostProcessMaterial(UObject* Outer, const FName ObjectName)
+{
+	// EXR images store the flow vectors themselves, instead of their color wheel representation
+	if (ImageFormat == EImageFormat::EXR)
+	{
+		return CreateFlowVectorMaterial(Outer, ObjectName);
+	}
+
+	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
+	if (PostProcessMaterial == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load optical flow post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+
+	// Create the material instance and set the scale parameter
+	UMaterialInstanceDynamic* PostProcessMaterialInstance =
+		UMaterialInstanceDynamic::Create(PostProcessMaterial, Outer, ObjectName);
+	if (PostProcessMaterialInstance == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	PostProcessMaterialInstance->SetScalarParameterValue(*OpticalFlowScaleParameter, OpticalFlowScale);
+
+	return PostProcessMaterialInstance;
+}
+
+UMaterialInterface* FOpticalFlowImageTarget::CreateFlowVectorMaterial(UObject* Outer, const FName ObjectName) const
+{
+	// The material replaces the tonemapper, so flow vectors are written to output images unchanged
+	UMaterial* PostProcessMaterial = NewObject<UMaterial>(
+		Outer != nullptr ? Outer : GetTransientPackage(), ObjectName, RF_Transient);
+	PostProcessMaterial->MaterialDomain = EMaterialDomain::MD_PostProcess;
+	PostProcessMaterial->BlendableLocation = EBlendableLocation::BL_ReplacingTonemapper;
+
+	// Scene depth and viewport position of the pixel
+	UMaterialExpressionSceneTexture* SceneDepth = Cast<UMaterialExpressionSceneTexture>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionSceneTexture::StaticClass()));
+	SceneDepth->SceneTextureId = ESceneTextureId::PPI_SceneDepth;
+	UMaterialExpressionComponentMask* DepthMask = Cast<UMaterialExpressionComponentMask>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionComponentMask::StaticClass()));
+	DepthMask->R = true;
+	DepthMask->G = false;
+	DepthMask->B = false;
+	DepthMask->A = false;
+	UMaterialEditingLibrary::ConnectMaterialExpressions(SceneDepth, TEXT("Color"), DepthMask, TEXT(""));
+	UMaterialExpressionScreenPosition* ScreenPosition = Cast<UMaterialExpressionScreenPosition>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionScreenPosition::StaticClass()));
+
+	// Same as the color wheel material, the pixel is projected into the previous frame assuming a static scene,
+	// and the vector from there to the current position is written into R and G, in image sizes
+	UMaterialExpressionCustom* FlowVector = Cast<UMaterialExpressionCustom>(
+		UMaterialEditingLibrary::CreateMaterialExpression(PostProcessMaterial, UMaterialExpressionCustom::StaticClass()));
+	FlowVector->OutputType = ECustomMaterialOutputType::CMOT_Float3;
+	FlowVector->Inputs.Empty();
+	FlowVector->Inputs.AddDefaulted_GetRef().InputName = TEXT("UV");
+	FlowVector->Inputs.AddDefaulted_GetRef().InputName = TEXT("Depth");
+	FlowVector->Code = TEXT(
+		"float2 ScreenPos = UV * float2(2, -2) + float2(-1, 1);\n"
+		"float4 PrevClipPos = mul(float4(ScreenPos, ConvertToDeviceZ(Depth), 1), View.ClipToPrevClip);\n"
+		"float2 PrevScreenPos = PrevClipPos.xy / PrevClipPos.w;\n"
+		"return float3((ScreenPos - PrevScreenPos) * float2(0.5, -0.5), 0);");
+	UMaterialEditingLibrary::ConnectMaterialExpressions(ScreenPosition, TEXT("ViewportUV"), FlowVector, TEXT("UV"));
+	UMaterialEditingLibrary::ConnectMaterialExpressions(DepthMask, TEXT(""), FlowVector, TEXT("Depth"));
+	UMaterialEditingLibrary::ConnectMaterialProperty(FlowVector, TEXT(""), MP_EmissiveColor);
+
+	UMaterialEditingLibrary::RecompileMaterial(PostProcessMaterial);
+
+	return PostProcessMaterial;
+}
+
+FEXRChannelSchemaLocal FOpticalFlowImageTarget::ExrChannelSchema() const
+{
+	// The flow vector material writes u and v into the R and G channels as they are
+	FEXRChannelSchemaLocal ChannelSchema;
+	ChannelSchema.ChannelNames = { TEXT("u"), TEXT("v") };
+	ChannelSchema.SourceChannels = { 0, 1 };
+	ChannelSchema.bFullFloat = true;
+	return ChannelSchema;
+}
+
 bool FOpticalFlowImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
 {
 	return ClearCameraPostProcess(LevelSequence);
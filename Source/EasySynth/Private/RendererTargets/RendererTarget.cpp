@@ -2,16 +2,39 @@
 
 #include "RendererTargets/RendererTarget.h"
 
-#include "ILevelSequenceEditorToolkit.h"
-#include "ISequencer.h"
+#include "Camera/CameraComponent.h"
 #include "LevelSequence.h"
 #include "MovieScene.h"
 #include "Sections/MovieSceneCameraCutSection.h"
-#include "Subsystems/AssetEditorSubsystem.h"
 
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "SequencerWrapper.h"
 
 
+FEXRChannelSchemaLocal FRendererTarget::ExrChannelSchema() const
+{
+	return FEXRChannelSchemaLocal();
+}
+
+TMap<FString, FEXRChannelSchemaLocal> FRendererTarget::ExrPassChannelSchemas() const
+{
+	TMap<FString, FEXRChannelSchemaLocal> ChannelSchemas;
+	ChannelSchemas.Add(FString(), ExrChannelSchema());
+	return ChannelSchemas;
+}
+
+TMap<FString, FEXRCompressionLocal> FRendererTarget::ExrPassCompressions() const
+{
+	TMap<FString, FEXRCompressionLocal> Compressions;
+	if (ExrCompressionValue.IsSet())
+	{
+		FEXRCompressionLocal& Compression = Compressions.Add(FString());
+		Compression.Format = ExrCompressionValue.GetValue();
+		Compression.DWACompressionLevel = DwaCompressionLevelValue;
+	}
+	return Compressions;
+}
+
 TArray<UCameraComponent*> FRendererTarget::GetCameras(ULevelSequence* LevelSequence)
 {
 	TArray<UCameraComponent*> Cameras;
@@ -28,16 +51,28 @@ TArray<UCameraComponent*> FRendererTarget::GetCameras(ULevelSequence* LevelSeque
 	for (auto CutSection : CutSections)
 	{
 		// Get the camera componenet
-		UCameraComponent* Camera = CutSection->GetFirstCamera(
-			*SequencerWrapper.GetSequencer(),
-			SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
+		UCameraComponent* Camera = SequencerWrapper.GetCutSectionCamera(CutSection);
 		if (Camera == nullptr)
 		{
 			UE_LOG(LogEasySynth, Error, TEXT("%s: Cut section camera component is null"), *FString(__FUNCTION__))
 			Cameras.Empty();
 			return Cameras;
 		}
-		Cameras.Add(Camera);
+		Cameras.AddUnique(Camera);
+
+		// Other rig cameras of the same actor are rendered as well only when all rig cameras share a job,
+		// otherwise the cut section camera takes the place of the rendered one
+		AActor* CameraOwner = Camera->GetOwner();
+		if (bAllRigCamerasValue && CameraOwner != nullptr)
+		{
+			TArray<UCameraComponent*> RigCameras;
+			const bool bIncludeFromChildActors = true;
+			CameraOwner->GetComponents<UCameraComponent>(RigCameras, bIncludeFromChildActors);
+			for (UCameraComponent* RigCamera : RigCameras)
+			{
+				Cameras.AddUnique(RigCamera);
+			}
+		}
 	}
 
 	return Cameras;
@@ -3,7 +3,9 @@
 #include "RendererTargets/SemanticImageTarget.h"
 
 #include "Camera/CameraComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
 
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "LevelSequence.h"
 #include "TextureStyles/TextureStyleManager.h"
 
@@ -11,7 +13,7 @@
 bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 {
 	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::SEMANTIC);
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
 
 	// Get all camera components bound to the level sequence
 	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
@@ -22,10 +24,9 @@ bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
+	UMaterialInterface* PostProcessMaterial = CreatePostProcessMaterial();
 	if (PostProcessMaterial == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load semantic post process material"), *FString(__FUNCTION__))
 		return false;
 	}
 
@@ -43,6 +44,38 @@ bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
+UMaterialInterface* FSemanticImageTarget::CreatePostProcessMaterial(UObject* Outer, const FName ObjectName)
+{
+	if (!bStencilMode)
+	{
+		UMaterial* PostProcessMaterial = LoadPostProcessMaterial(Outer, ObjectName);
+		if (PostProcessMaterial == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load semantic post process material"), *FString(__FUNCTION__))
+		}
+		return PostProcessMaterial;
+	}
+
+	// Stencil values are painted by the texture style manager once the stencil mode is selected
+	UMaterial* StencilMaterial = TextureStyleManager->SemanticStencilMaterial();
+	if (StencilMaterial == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create semantic stencil post process material"),
+			*FString(__FUNCTION__))
+		return nullptr;
+	}
+
+	// Wrap the shared material, so that the instance can be named after the target
+	return UMaterialInstanceDynamic::Create(StencilMaterial, Outer, ObjectName);
+}
+
+FEXRChannelSchemaLocal FSemanticImageTarget::ExrChannelSchema() const
+{
+	FEXRChannelSchemaLocal ChannelSchema;
+	ChannelSchema.bPointSampled = true;
+	return ChannelSchema;
+}
+
 bool FSemanticImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
 {
 	return ClearCameraPostProcess(LevelSequence);
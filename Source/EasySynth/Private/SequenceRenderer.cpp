@@ -2,11 +2,19 @@
 
 #include "SequenceRenderer.h"
 
+#include "AssetCompilingManager.h"
 #include "CineCameraComponent.h"
+#include "ContentStreaming.h"
+#include "MoviePipelineAntiAliasingSetting.h"
+#include "MoviePipelineCameraSetting.h"
+#include "MoviePipelineDeferredPasses.h"
 #include "MoviePipelineImageSequenceOutput.h"
+#include "MoviePipelineInProcessExecutor.h"
 #include "MoviePipelineOutputSetting.h"
 #include "MoviePipelineQueueSubsystem.h"
 #include "MovieRenderPipelineSettings.h"
+#include "MovieSceneTimeHelpers.h"
+#include "ShaderCompiler.h"
 
 #include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "PathUtils.h"
@@ -17,14 +25,32 @@
 
 const float FRendererTargetOptions::DefaultDepthRangeMetersValue = 100.0f;
 const float FRendererTargetOptions::DefaultOpticalFlowScaleValue = 1.0f;
+const float FRendererTargetOptions::DefaultMaxReadinessWaitSecondsValue = 10.0f;
 
 FRendererTargetOptions::FRendererTargetOptions() :
 	bExportCameraPoses(false),
+	bSinglePassRendering(false),
+	bTargetMajorOrder(false),
+	bRenderAllRigCameras(false),
 	DepthRangeMetersValue(DefaultDepthRangeMetersValue),
-	OpticalFlowScaleValue(DefaultOpticalFlowScaleValue)
+	OpticalFlowScaleValue(DefaultOpticalFlowScaleValue),
+	bResumeRendering(false),
+	bSemanticStencilMode(false),
+	ShardIndexValue(0),
+	ShardCountValue(1),
+	FrameRangeStartValue(0),
+	FrameRangeEndValue(0),
+	FrameStrideValue(1),
+	MinFrameTranslationValue(0.0f),
+	MinFrameRotationValue(0.0f),
+	MaxReadinessWaitSecondsValue(DefaultMaxReadinessWaitSecondsValue)
 {
 	SelectedTargets.Init(false, TargetType::COUNT);
 	OutputFormats.Init(EImageFormat::JPEG, TargetType::COUNT);
+	OutputFormats[INSTANCE_IMAGE] = EImageFormat::PNG;
+	ResolutionScales.Init(1.0f, TargetType::COUNT);
+	ExrCompressions.SetNum(TargetType::COUNT);
+	DwaCompressionLevels.Init(45.0f, TargetType::COUNT);
 }
 
 bool FRendererTargetOptions::AnyOptionSelected() const
@@ -39,27 +65,139 @@ bool FRendererTargetOptions::AnyOptionSelected() const
 	return false;
 }
 
+bool FRendererTargetOptions::FrameSelectionValid() const
+{
+	return
+		ShardCountValue > 0 && ShardIndexValue >= 0 && ShardIndexValue < ShardCountValue &&
+		FrameRangeStartValue >= 0 && FrameRangeEndValue >= 0 &&
+		(FrameRangeStartValue == 0 || FrameRangeStartValue < FrameRangeEndValue) &&
+		FrameStrideValue > 0 && MinFrameTranslationValue >= 0.0f && MinFrameRotationValue >= 0.0f;
+}
+
+bool FRendererTargetOptions::ResolutionScalesValid() const
+{
+	for (const float ResolutionScale : ResolutionScales)
+	{
+		if (ResolutionScale <= 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FRendererTargetOptions::OutputFormatsValid() const
+{
+	// Compression artifacts would turn instance colors into IDs of other instances
+	if (SelectedTargets[INSTANCE_IMAGE] && OutputFormats[INSTANCE_IMAGE] == EImageFormat::JPEG)
+	{
+		return false;
+	}
+
+	// The same goes for lossy EXR compressions of both semantic and instance colors
+	for (int i = 0; i < TargetType::COUNT; i++)
+	{
+		if (SelectedTargets[i] && EncodesIds(i) && OutputFormats[i] == EImageFormat::EXR &&
+			ExrCompressions[i].IsSet() && IsLossyExrCompression(ExrCompressions[i].GetValue()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FRendererTargetOptions::IsLossyExrCompression(const EEXRCompressionFormatLocal Compression)
+{
+	// PXR24 only rounds 32-bit float channels, while colors are written as 16-bit halves
+	return
+		Compression == EEXRCompressionFormatLocal::DWAA ||
+		Compression == EEXRCompressionFormatLocal::DWAB ||
+		Compression == EEXRCompressionFormatLocal::B44 ||
+		Compression == EEXRCompressionFormatLocal::B44A;
+}
+
+void FRendererTargetOptions::GetRenderFrameRange(const int FrameCount, int& OutStartFrame, int& OutEndFrame) const
+{
+	if (FrameRangeStartValue < FrameRangeEndValue)
+	{
+		OutStartFrame = FMath::Min(FrameRangeStartValue, FrameCount);
+		OutEndFrame = FMath::Min(FrameRangeEndValue, FrameCount);
+	}
+	else
+	{
+		// Shards differ in size by one frame at most
+		OutStartFrame = static_cast<int64>(FrameCount) * ShardIndexValue / ShardCountValue;
+		OutEndFrame = static_cast<int64>(FrameCount) * (ShardIndexValue + 1) / ShardCountValue;
+	}
+}
+
 void FRendererTargetOptions::GetSelectedTargets(
 	UTextureStyleManager* TextureStyleManager,
-	TQueue<TSharedPtr<FRendererTarget>>& OutTargetsQueue) const
+	TArray<TSharedPtr<FRendererTarget>>& OutTargets) const
 {
-	OutTargetsQueue.Empty();
+	OutTargets.Empty();
+
+	// Groups of targets that can be rendered by the same job,
+	// each group containing a single target unless single pass rendering is requested
+	TArray<TArray<TSharedPtr<FRendererTarget>>> TargetGroups;
+
 	for (int i = 0; i < TargetType::COUNT; i++)
 	{
 		if (SelectedTargets[i])
 		{
 			TSharedPtr<FRendererTarget> Target = RendererTarget(i, TextureStyleManager);
-			if (Target != nullptr)
-			{
-				OutTargetsQueue.Enqueue(Target);
-			}
-			else
+			if (Target == nullptr)
 			{
 				UE_LOG(LogEasySynth, Error, TEXT("%s: Target selection mapped to null renderer target"),
 					*FString(__FUNCTION__))
-				OutTargetsQueue.Empty();
+				OutTargets.Empty();
 				return;
 			}
+			Target->SetResolutionScale(ResolutionScales[i]);
+			if (ExrCompressions[i].IsSet())
+			{
+				Target->SetExrCompression(ExrCompressions[i].GetValue(), DwaCompressionLevels[i]);
+			}
+
+			// Targets can share a job only if they need the same texture style, output format,
+			// anti-aliasing and resolution
+			TArray<TSharedPtr<FRendererTarget>>* MatchingGroup = nullptr;
+			if (bSinglePassRendering)
+			{
+				MatchingGroup = TargetGroups.FindByPredicate(
+					[&Target](const TArray<TSharedPtr<FRendererTarget>>& TargetGroup)
+					{
+						return
+							TargetGroup[0]->TextureStyle() == Target->TextureStyle() &&
+							TargetGroup[0]->ImageFormat == Target->ImageFormat &&
+							TargetGroup[0]->AntiAliasingOverrides() == Target->AntiAliasingOverrides() &&
+							TargetGroup[0]->ResolutionScale() == Target->ResolutionScale();
+					});
+			}
+
+			if (MatchingGroup != nullptr)
+			{
+				MatchingGroup->Add(Target);
+			}
+			else
+			{
+				TargetGroups.Add({ Target });
+			}
+		}
+	}
+
+	for (const TArray<TSharedPtr<FRendererTarget>>& TargetGroup : TargetGroups)
+	{
+		if (TargetGroup.Num() == 1)
+		{
+			OutTargets.Add(TargetGroup[0]);
+		}
+		else
+		{
+			TSharedPtr<FRendererTarget> MultiPassTarget = MakeShared<FMultiPassImageTarget>(
+				TextureStyleManager, TargetGroup[0]->ImageFormat, TargetGroup);
+			MultiPassTarget->SetResolutionScale(TargetGroup[0]->ResolutionScale());
+			OutTargets.Add(MultiPassTarget);
 		}
 	}
 }
@@ -77,15 +215,31 @@ TSharedPtr<FRendererTarget> FRendererTargetOptions::RendererTarget(
 	case NORMAL_IMAGE: return MakeShared<FNormalImageTarget>(TextureStyleManager, OutputFormat); break;
 	case OPTICAL_FLOW_IMAGE: return MakeShared<FOpticalFlowImageTarget>(
 		TextureStyleManager, OutputFormat, OpticalFlowScaleValue); break;
-	case SEMANTIC_IMAGE: return MakeShared<FSemanticImageTarget>(TextureStyleManager, OutputFormat); break;
+	case SEMANTIC_IMAGE: return MakeShared<FSemanticImageTarget>(
+		TextureStyleManager, OutputFormat, bSemanticStencilMode); break;
+	case INSTANCE_IMAGE: return MakeShared<FInstanceImageTarget>(TextureStyleManager, OutputFormat); break;
 	default: return nullptr;
 	}
 }
 
+const float USequenceRenderer::ReadinessCheckIntervalSeconds = 0.1f;
+const float USequenceRenderer::StreamingSettleSeconds = 1.0f;
+const float USequenceRenderer::ManifestFlushIntervalSeconds = 10.0f;
+
 USequenceRenderer::USequenceRenderer() :
 	EasySynthMoviePipelineConfig(DuplicateObject<UMoviePipelineMasterConfig>(
 		LoadObject<UMoviePipelineMasterConfig>(nullptr, *FPathUtils::DefaultMoviePipelineConfigPath()), nullptr)),
+	SequenceStartFrame(0),
+	SequenceFrameCount(0),
+	RenderStartFrame(0),
+	RenderEndFrame(0),
+	CurrentStartFrame(0),
+	CurrentEndFrame(0),
+	CurrentFrameStep(1),
 	bCurrentlyRendering(false),
+	ReadinessWaitStartTime(0.0),
+	LowestNumWantingResources(MAX_int32),
+	LastStreamingProgressTime(0.0),
 	ErrorMessage("")
 {
 	// Check if the config asset is loaded correctly
@@ -95,6 +249,30 @@ USequenceRenderer::USequenceRenderer() :
 		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		check(EasySynthMoviePipelineConfig)
 	}
+
+	// Remember the default file name format, as multi-pass rendering extends it
+	UMoviePipelineOutputSetting* OutputSetting =
+		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineOutputSetting>();
+	if (OutputSetting != nullptr)
+	{
+		DefaultFileNameFormat = OutputSetting->FileNameFormat;
+	}
+
+	// Remember the default anti-aliasing settings, as targets can override them
+	const UMoviePipelineAntiAliasingSetting* AntiAliasingSetting =
+		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineAntiAliasingSetting>();
+	if (AntiAliasingSetting == nullptr)
+	{
+		AntiAliasingSetting = GetDefault<UMoviePipelineAntiAliasingSetting>();
+	}
+	DefaultAntiAliasing.SpatialSampleCount = AntiAliasingSetting->SpatialSampleCount;
+	DefaultAntiAliasing.TemporalSampleCount = AntiAliasingSetting->TemporalSampleCount;
+	if (AntiAliasingSetting->bOverrideAntiAliasing)
+	{
+		DefaultAntiAliasing.AntiAliasingMethod = AntiAliasingSetting->AntiAliasingMethod.GetValue();
+	}
+	DefaultAntiAliasing.EngineWarmUpCount = AntiAliasingSetting->EngineWarmUpCount;
+	DefaultAntiAliasing.RenderWarmUpCount = AntiAliasingSetting->RenderWarmUpCount;
 }
 
 bool USequenceRenderer::RenderSequence(
@@ -136,6 +314,30 @@ bool USequenceRenderer::RenderSequence(
 		return false;
 	}
 
+	// Check if the frame selection is valid
+	if (!RenderingTargets.FrameSelectionValid())
+	{
+		ErrorMessage = "Invalid shard, frame range or frame selection";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Check if the target resolution scales are valid
+	if (!RenderingTargets.ResolutionScalesValid())
+	{
+		ErrorMessage = "Target resolution scales have to be positive";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Check if the target output formats are valid
+	if (!RenderingTargets.OutputFormatsValid())
+	{
+		ErrorMessage = "Instance images have to be rendered as PNG or EXR, and EXR semantic and instance images need a lossless compression";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
 	// Store parameters
 	RendererTargetOptions = RenderingTargets;
 	OutputResolution = OutputImageResolution;
@@ -145,7 +347,14 @@ bool USequenceRenderer::RenderSequence(
 	FSequencerWrapper SequencerWrapper;
 	if (!SequencerWrapper.OpenSequence(LevelSequence))
 	{
-		ErrorMessage = "Sequencer wrapper opening failed";
+		ErrorMessage = FString::Printf(TEXT("Sequencer wrapper opening failed: %s"), *SequencerWrapper.GetErrorMessage());
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Find the part of the sequence to be rendered
+	if (!SelectRenderFrameRange(SequencerWrapper))
+	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
@@ -160,9 +369,7 @@ bool USequenceRenderer::RenderSequence(
 	UMovieSceneCameraCutSection* CutSection = CutSections[0];
 
 	// Get the sequence source actor
-	TArrayView<TWeakObjectPtr<>> SourceObjects = SequencerWrapper.GetSequencer()->FindBoundObjects(
-		CutSection->GetCameraBindingID().GetGuid(),
-		SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
+	TArray<UObject*> SourceObjects = SequencerWrapper.FindBoundObjects(CutSection->GetCameraBindingID().GetGuid());
 	if (SourceObjects.Num() == 0)
 	{
 		ErrorMessage = "No sources assigned to the sequencer";
@@ -171,7 +378,7 @@ bool USequenceRenderer::RenderSequence(
 	}
 
 	// Assume the same source actor is used throughout the camera cut
-	CameraRigActor = Cast<AActor>(SourceObjects[0].Get());
+	CameraRigActor = Cast<AActor>(SourceObjects[0]);
 	if (CameraRigActor == nullptr)
 	{
 		ErrorMessage = "Expected an actor as a sequence source";
@@ -181,7 +388,6 @@ bool USequenceRenderer::RenderSequence(
 
 	// Prepare rig cameras information
 	RigCameras.Empty();
-	CurrentRigCameraId = -1;
 
 	// Find all camera components inside the source actor
 	TArray<UActorComponent*> ActorComponents;
@@ -229,6 +435,13 @@ bool USequenceRenderer::RenderSequence(
 		return A.GetReadableName().Compare(B.GetReadableName()) < 0;
 	});
 
+	// Select frames to be rendered, which needs the camera rig poses if frames are selected by the camera movement
+	if (!SelectRenderFrames())
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
 	// Export camera rig information
 	FCameraRigRosInterface CameraRigRosInterface;
 	if (!CameraRigRosInterface.ExportCameraRig(RenderingDirectory, RigCameras, OutputResolution))
@@ -242,6 +455,7 @@ bool USequenceRenderer::RenderSequence(
 	if (RendererTargetOptions.ExportCameraPoses())
 	{
 		FCameraPoseExporter CameraPoseExporter;
+		ApplyRenderFrameRange(CameraPoseExporter);
 		UCameraComponent* NoSpecificCamera = nullptr;
 		if (!CameraPoseExporter.ExportCameraPoses(
 			RenderingSequence, OutputResolution, RenderingDirectory, NoSpecificCamera))
@@ -252,6 +466,18 @@ bool USequenceRenderer::RenderSequence(
 		}
 	}
 
+	// Remember the transform of the first camera, which is moved around the rig during the rendering
+	OriginalCameraTransform = RigCameras[0]->GetRelativeTransform();
+	OriginalCameraFOV = RigCameras[0]->FieldOfView;
+
+	// Export camera poses if requested
+	if (RendererTargetOptions.ExportCameraPoses() && !ExportRigCameraPoses())
+	{
+		ErrorMessage = "Could not export camera poses";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
 	// Export semantic class information if semantic rendering is selected
 	if (RendererTargetOptions.TargetSelected(FRendererTargetOptions::TargetType::SEMANTIC_IMAGE))
 	{
@@ -263,18 +489,92 @@ bool USequenceRenderer::RenderSequence(
 		}
 	}
 
+	// Export instance IDs if instance rendering is selected
+	if (RendererTargetOptions.TargetSelected(FRendererTargetOptions::TargetType::INSTANCE_IMAGE))
+	{
+		if (!TextureStyleManager->ExportInstances(RenderingDirectory))
+		{
+			ErrorMessage = "Could not save the instances CSV file";
+			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+			return false;
+		}
+	}
+
+	// Select how semantic classes are displayed before the texture style to be restored is remembered
+	TextureStyleManager->SetSemanticStencilMode(RendererTargetOptions.SemanticStencilMode());
 	OriginalTextureStyle = TextureStyleManager->SelectedTextureStyle();
+	// Save pending semantic modifications now, instead of in the middle of rendering
+	TextureStyleManager->FlushTextureMappingAsset();
+
+	// Create the targets once and plan the order in which they are rendered by rig cameras
+	TArray<TSharedPtr<FRendererTarget>> Targets;
+	RendererTargetOptions.GetSelectedTargets(TextureStyleManager, Targets);
+	if (Targets.Num() == 0)
+	{
+		ErrorMessage = "Could not create the selected renderer targets";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Export the camera rig with intrinsics matching the resolution of each rescaled target
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		if (Target->ResolutionScale() == 1.0f)
+		{
+			continue;
+		}
+		for (const FString& TargetName : Target->OutputNames())
+		{
+			if (!CameraRigRosInterface.ExportCameraRig(
+				RenderingDirectory, RigCameras, Target->OutputResolution(OutputResolution), TargetName))
+			{
+				ErrorMessage = FString::Printf(TEXT("Could not save the %s camera rig ROS JSON file"), *TargetName);
+				UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+				return false;
+			}
+		}
+	}
+	TArray<FRenderWorkItem> WorkItems;
+	FRenderPlanner::PlanWork(
+		Targets,
+		RigCameras.Num(),
+		RendererTargetOptions.TargetMajorOrder(),
+		RendererTargetOptions.RenderAllRigCameras(),
+		OriginalTextureStyle,
+		RenderStartFrame,
+		RenderEndFrame,
+		WorkItems);
+
+	// Prepare the render manifest and skip the work finished by previous renderings if resuming
+	if (!RenderManifest.Open(
+		RenderingDirectory, RenderStartFrame, RenderEndFrame, RendererTargetOptions.ResumeRendering()))
+	{
+		ErrorMessage = "Could not create the render manifest file";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+	EnqueueUnfinishedWork(WorkItems);
+	CurrentRigCameraId = -1;
+	CurrentTarget = nullptr;
 
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering..."), *FString(__FUNCTION__))
 	bCurrentlyRendering = true;
 
-	FindNextCamera();
+	FindNextWorkItem();
 
 	return true;
 }
 
 void USequenceRenderer::OnExecutorFinished(UMoviePipelineExecutorBase* InPipelineExecutor, bool bSuccess)
 {
+	// Record all outputs of the finished work item, as no more writes are pending
+	FTSTicker::GetCoreTicker().RemoveTicker(ManifestTickerHandle);
+	if (bSuccess)
+	{
+		RenderManifest.ScanOutputs(true);
+	}
+	RenderManifest.Flush();
+
 	// Revert target specific modifications to the sequence
 	if (!CurrentTarget->FinalizeSequence(RenderingSequence))
 	{
@@ -288,85 +588,346 @@ void USequenceRenderer::OnExecutorFinished(UMoviePipelineExecutorBase* InPipelin
 		return BroadcastRenderingFinished(false);
 	}
 
-	// Successful rendering, proceed to the next target
-	FindNextTarget();
+	// Successful rendering, proceed to the next work item
+	FindNextWorkItem();
 }
 
-void USequenceRenderer::FindNextCamera()
+void USequenceRenderer::EnqueueUnfinishedWork(const TArray<FRenderWorkItem>& WorkItems)
 {
-	CurrentRigCameraId++;
+	WorkQueue.Empty();
 
-	// Check if the end is reached
-	if (CurrentRigCameraId == RigCameras.Num())
+	int FinishedFrames = 0;
+	int NeededFrames = 0;
+	int ExtraFrames = 0;
+	int JobCount = 0;
+	for (const FRenderWorkItem& WorkItem : WorkItems)
 	{
-		return BroadcastRenderingFinished(true);
+		// Collect selected frames missing any of the work item outputs
+		const TArray<FString> CameraNames = RigCameraNames(WorkItem.RigCameraId);
+		const TArray<FString> TargetNames = WorkItem.Target->OutputNames();
+		TArray<int> Frames;
+		for (int Frame = WorkItem.StartFrame; Frame < WorkItem.EndFrame; Frame++)
+		{
+			if (!SelectedFrames[Frame])
+			{
+				continue;
+			}
+
+			bool bFrameMissing = !RendererTargetOptions.ResumeRendering();
+			for (int i = 0; i < CameraNames.Num() && !bFrameMissing; i++)
+			{
+				for (int j = 0; j < TargetNames.Num() && !bFrameMissing; j++)
+				{
+					bFrameMissing = !RenderManifest.Contains(CameraNames[i], TargetNames[j], SequenceStartFrame + Frame);
+				}
+			}
+
+			if (bFrameMissing)
+			{
+				Frames.Add(Frame);
+			}
+			else
+			{
+				FinishedFrames++;
+			}
+		}
+
+		// Each run of evenly spaced frames is rendered by its own job, frames rendered
+		// in between are not recorded inside the render manifest
+		TArray<FRenderWorkItem> Runs;
+		NeededFrames += Frames.Num();
+		ExtraFrames += FRenderPlanner::SplitIntoRuns(WorkItem, Frames, Runs);
+		JobCount += Runs.Num();
+		for (const FRenderWorkItem& Run : Runs)
+		{
+			WorkQueue.Enqueue(Run);
+		}
 	}
 
-	if (CurrentRigCameraId == 0)
+	// Merged runs of an irregular frame selection can render more frames than were selected
+	if (ExtraFrames > NeededFrames)
 	{
-		// Remember the transform of the first camera
-		OriginalCameraTransform = RigCameras[0]->GetRelativeTransform();
-		OriginalCameraFOV = RigCameras[0]->FieldOfView;
+		UE_LOG(LogEasySynth, Warning,
+			TEXT("%s: Rendering %d not needed frames next to %d needed ones in %d jobs, the frame selection saves little time"),
+			*FString(__FUNCTION__), ExtraFrames, NeededFrames, JobCount)
 	}
-	else
+	else if (ExtraFrames > 0)
 	{
-		// Transfer the transform of the current camera to the first one that is used for rendering
-		RigCameras[0]->SetRelativeTransform(RigCameras[CurrentRigCameraId]->GetRelativeTransform());
-		RigCameras[0]->SetFieldOfView(RigCameras[CurrentRigCameraId]->FieldOfView);
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering %d not needed frames to reduce the number of jobs to %d"),
+			*FString(__FUNCTION__), ExtraFrames, JobCount)
 	}
 
-	// Export camera poses if requested
-	if (RendererTargetOptions.ExportCameraPoses())
+	if (RendererTargetOptions.ResumeRendering())
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Skipping %d frames finished by previous renderings"),
+			*FString(__FUNCTION__), FinishedFrames)
+	}
+}
+
+TArray<FString> USequenceRenderer::RigCameraNames(const int RigCameraId) const
+{
+	TArray<FString> CameraNames;
+	for (int i = 0; i < RigCameras.Num(); i++)
+	{
+		if (RigCameraId == i || RigCameraId == FRenderWorkItem::AllRigCameras)
+		{
+			CameraNames.Add(FPathUtils::GetCameraName(RigCameras[i]));
+		}
+	}
+	return CameraNames;
+}
+
+void USequenceRenderer::ExpectCurrentOutputs()
+{
+	// Only frames rendered by the current work item may be recorded,
+	// frames in between are rendered by other work items or not at all
+	TArray<int> Frames;
+	for (int Frame = CurrentStartFrame; Frame < CurrentEndFrame; Frame += CurrentFrameStep)
+	{
+		if (SelectedFrames.IsValidIndex(Frame) && SelectedFrames[Frame])
+		{
+			Frames.Add(SequenceStartFrame + Frame);
+		}
+	}
+
+	for (const FString& CameraName : RigCameraNames(CurrentRigCameraId))
+	{
+		for (const FString& TargetName : CurrentTarget->OutputNames())
+		{
+			RenderManifest.ExpectOutputs(CameraName, TargetName, Frames);
+		}
+	}
+}
+
+bool USequenceRenderer::OnManifestFlushTick(float DeltaTime)
+{
+	RenderManifest.ScanOutputs(false);
+	RenderManifest.Flush();
+
+	// Keep ticking until removed
+	return true;
+}
+
+bool USequenceRenderer::SelectRenderFrameRange(FSequencerWrapper& SequencerWrapper)
+{
+	// Convert the playback range from ticks to display frames, which is what output frames are counted in
+	UMovieScene* MovieScene = SequencerWrapper.GetMovieScene();
+	const FFrameRate DisplayRate = MovieScene->GetDisplayRate();
+	const FFrameRate TickResolution = MovieScene->GetTickResolution();
+	const TRange<FFrameNumber> PlaybackRange = MovieScene->GetPlaybackRange();
+	const FFrameNumber StartFrame = FFrameRate::TransformTime(
+		UE::MovieScene::DiscreteInclusiveLower(PlaybackRange), TickResolution, DisplayRate).FloorToFrame();
+	const FFrameNumber EndFrame = FFrameRate::TransformTime(
+		UE::MovieScene::DiscreteExclusiveUpper(PlaybackRange), TickResolution, DisplayRate).CeilToFrame();
+	SequenceStartFrame = StartFrame.Value;
+	SequenceFrameCount = (EndFrame - StartFrame).Value;
+
+	RendererTargetOptions.GetRenderFrameRange(SequenceFrameCount, RenderStartFrame, RenderEndFrame);
+	if (RenderStartFrame >= RenderEndFrame)
+	{
+		ErrorMessage = "No sequence frames inside the selected shard or frame range";
+		return false;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering frames [%d, %d) out of %d"),
+		*FString(__FUNCTION__), RenderStartFrame, RenderEndFrame, SequenceFrameCount)
+
+	return true;
+}
+
+bool USequenceRenderer::SelectRenderFrames()
+{
+	// Rig poses are only needed to measure the camera movement between frames
+	TArray<FTransform> CameraTransforms;
+	if (RendererTargetOptions.PoseBasedFrameSelection())
 	{
 		FCameraPoseExporter CameraPoseExporter;
-		if (!CameraPoseExporter.ExportCameraPoses(
-			RenderingSequence, OutputResolution, RenderingDirectory, RigCameras[CurrentRigCameraId]))
+		if (!CameraPoseExporter.ExtractRigPoses(RenderingSequence, CameraTransforms))
 		{
-			ErrorMessage = "Could not export camera poses";
-			return BroadcastRenderingFinished(false);
+			ErrorMessage = "Could not extract camera rig poses needed for the frame selection";
+			return false;
 		}
 	}
 
-	// Prepare the targets queue
-	RendererTargetOptions.GetSelectedTargets(TextureStyleManager, TargetsQueue);
-	CurrentTarget = nullptr;
+	FRenderPlanner::SelectFrames(
+		CameraTransforms,
+		RenderStartFrame,
+		RenderEndFrame,
+		RendererTargetOptions.FrameStride(),
+		RendererTargetOptions.MinFrameTranslation(),
+		RendererTargetOptions.MinFrameRotation(),
+		SelectedFrames);
+
+	const int SelectedFrameCount = SelectedFrames.CountSetBits();
+	if (SelectedFrameCount == 0)
+	{
+		ErrorMessage = "No sequence frames selected for rendering";
+		return false;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Selected %d out of %d frames for rendering"),
+		*FString(__FUNCTION__), SelectedFrameCount, RenderEndFrame - RenderStartFrame)
+
+	return true;
+}
+
+void USequenceRenderer::ApplyRenderFrameRange(FCameraPoseExporter& CameraPoseExporter) const
+{
+	if (RenderStartFrame > 0 || RenderEndFrame < SequenceFrameCount)
+	{
+		CameraPoseExporter.SetFrameRange(RenderStartFrame, RenderEndFrame);
+	}
+	if (SelectedFrames.CountSetBits() < RenderEndFrame - RenderStartFrame)
+	{
+		CameraPoseExporter.SetSelectedFrames(SelectedFrames);
+	}
+}
+
+bool USequenceRenderer::ExportRigCameraPoses()
+{
+	// The pose exporter offsets rig poses by the transform of the first camera,
+	// so each camera needs to take its place while its poses are exported
+	bool bSuccess = true;
+	for (int RigCameraId = 0; RigCameraId < RigCameras.Num() && bSuccess; RigCameraId++)
+	{
+		SelectRigCamera(RigCameraId);
 
-	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering camera %d/%d"), *FString(__FUNCTION__), CurrentRigCameraId + 1, RigCameras.Num())
+		FCameraPoseExporter CameraPoseExporter;
+		ApplyRenderFrameRange(CameraPoseExporter);
+		bSuccess = CameraPoseExporter.ExportCameraPoses(
+			RenderingSequence, OutputResolution, RenderingDirectory, RigCameras[RigCameraId]);
+	}
+	SelectRigCamera(0);
+
+	return bSuccess;
+}
 
-	// Find the next target and start rendering
-	FindNextTarget();
+void USequenceRenderer::SelectRigCamera(const int RigCameraId)
+{
+	CurrentRigCameraId = RigCameraId;
+
+	if (RigCameraId == 0 || RigCameraId == FRenderWorkItem::AllRigCameras)
+	{
+		// Restore the original transform of the first camera
+		RigCameras[0]->SetRelativeTransform(OriginalCameraTransform);
+		RigCameras[0]->SetFieldOfView(OriginalCameraFOV);
+	}
+	else
+	{
+		// Transfer the transform of the current camera to the first one that is used for rendering
+		RigCameras[0]->SetRelativeTransform(RigCameras[RigCameraId]->GetRelativeTransform());
+		RigCameras[0]->SetFieldOfView(RigCameras[RigCameraId]->FieldOfView);
+	}
 }
 
-void USequenceRenderer::FindNextTarget()
+void USequenceRenderer::FindNextWorkItem()
 {
 	// Check if the end is reached
-	if (TargetsQueue.IsEmpty())
+	if (WorkQueue.IsEmpty())
 	{
-		return FindNextCamera();
+		return BroadcastRenderingFinished(true);
 	}
 
-	// Select the next requested target
-	TargetsQueue.Dequeue(CurrentTarget);
+	// Select the next work item
+	FRenderWorkItem WorkItem;
+	WorkQueue.Dequeue(WorkItem);
+	CurrentTarget = WorkItem.Target;
+	CurrentStartFrame = WorkItem.StartFrame;
+	CurrentEndFrame = WorkItem.EndFrame;
+	CurrentFrameStep = WorkItem.FrameStep;
+
+	// Move the rendering camera only when the work item needs a different one
+	if (WorkItem.RigCameraId != CurrentRigCameraId)
+	{
+		SelectRigCamera(WorkItem.RigCameraId);
+		if (CurrentRigCameraId == FRenderWorkItem::AllRigCameras)
+		{
+			UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering all %d cameras"), *FString(__FUNCTION__), RigCameras.Num())
+		}
+		else
+		{
+			UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering camera %d/%d"),
+				*FString(__FUNCTION__), CurrentRigCameraId + 1, RigCameras.Num())
+		}
+	}
 
 	// Setup specifics of the current rendering target
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering the %s target"), *FString(__FUNCTION__), *CurrentTarget->Name())
+	CurrentTarget->SetAllRigCameras(CurrentRigCameraId == FRenderWorkItem::AllRigCameras);
 	if (!CurrentTarget->PrepareSequence(RenderingSequence))
 	{
 		ErrorMessage = FString::Printf(TEXT("Failed while preparing the rendering of the %s target"), *CurrentTarget->Name());
 		return BroadcastRenderingFinished(false);
 	}
 
-	// Start the rendering after a brief pause
-	const float DelaySeconds = 2.0f;
-	const bool bLoop = false;
+	// Start the rendering as soon as the editor is ready for it
+	ReadinessWaitStartTime = FPlatformTime::Seconds();
+	LowestNumWantingResources = MAX_int32;
+	LastStreamingProgressTime = ReadinessWaitStartTime;
+	const bool bLoop = true;
 	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
 		RendererPauseTimerHandle,
 		this,
-		&USequenceRenderer::StartRendering,
-		DelaySeconds,
+		&USequenceRenderer::CheckRenderingReadiness,
+		ReadinessCheckIntervalSeconds,
 		bLoop);
 }
 
+void USequenceRenderer::CheckRenderingReadiness()
+{
+	const double WaitedSeconds = FPlatformTime::Seconds() - ReadinessWaitStartTime;
+	const bool bReady = IsReadyForRendering();
+	if (!bReady && WaitedSeconds < RendererTargetOptions.MaxReadinessWaitSeconds())
+	{
+		return;
+	}
+
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().ClearTimer(RendererPauseTimerHandle);
+
+	if (bReady)
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Waited %.2f s before rendering the %s target"),
+			*FString(__FUNCTION__), WaitedSeconds, *CurrentTarget->Name())
+	}
+	else
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Editor still busy after %.2f s, rendering the %s target anyway"),
+			*FString(__FUNCTION__), WaitedSeconds, *CurrentTarget->Name())
+	}
+
+	StartRendering();
+}
+
+bool USequenceRenderer::IsReadyForRendering()
+{
+	// Shaders needed by the target post process materials and texture styles
+	if (GShaderCompilingManager != nullptr && GShaderCompilingManager->IsCompiling())
+	{
+		return false;
+	}
+
+	// Textures, static meshes and other assets that compile asynchronously
+	if (FAssetCompilingManager::Get().GetNumRemainingAssets() > 0)
+	{
+		return false;
+	}
+
+	// Texture and mesh mips that still need to be streamed in, when the texture pool is over budget
+	// some resources keep wanting mips forever, so streaming is settled once the count stops decreasing
+	const int32 NumWantingResources = IStreamingManager::Get().GetNumWantingResources();
+	if (NumWantingResources < LowestNumWantingResources)
+	{
+		LowestNumWantingResources = NumWantingResources;
+		LastStreamingProgressTime = FPlatformTime::Seconds();
+	}
+	if (NumWantingResources > 0 && FPlatformTime::Seconds() - LastStreamingProgressTime < StreamingSettleSeconds)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 void USequenceRenderer::StartRendering()
 {
 	// Make sure the sequence is still sound
@@ -399,25 +960,44 @@ void USequenceRenderer::StartRendering()
 		return BroadcastRenderingFinished(false);
 	}
 
-	// Get the default movie rendering settings
-	const UMovieRenderPipelineProjectSettings* ProjectSettings = GetDefault<UMovieRenderPipelineProjectSettings>();
-	if (ProjectSettings->DefaultLocalExecutor == nullptr)
+	// Get the default movie rendering settings, unless a specific executor is requested
+	TSubclassOf<UMoviePipelineExecutorBase> ExecutorClass = ExecutorClassOverride;
+	if (ExecutorClass == nullptr)
 	{
-		ErrorMessage = "Could not get the UMovieRenderPipelineProjectSettings";
-		return BroadcastRenderingFinished(false);
+		const UMovieRenderPipelineProjectSettings* ProjectSettings = GetDefault<UMovieRenderPipelineProjectSettings>();
+		if (ProjectSettings->DefaultLocalExecutor == nullptr)
+		{
+			ErrorMessage = "Could not get the UMovieRenderPipelineProjectSettings";
+			return BroadcastRenderingFinished(false);
+		}
+		ExecutorClass = ProjectSettings->DefaultLocalExecutor.ResolveClass();
 	}
 
-	// Run the rendering
+	// The in-process executor renders the already prepared level instead of loading the map again
 	UMoviePipelineExecutorBase* ActiveExecutor =
-		MoviePipelineQueueSubsystem->RenderQueueWithExecutor(ProjectSettings->DefaultLocalExecutor.ResolveClass());
+		NewObject<UMoviePipelineExecutorBase>(MoviePipelineQueueSubsystem, ExecutorClass);
 	if (ActiveExecutor == nullptr)
 	{
-		ErrorMessage = "Could not start the rendering";
+		ErrorMessage = "Could not create the movie pipeline executor";
 		return BroadcastRenderingFinished(false);
 	}
+	UMoviePipelineInProcessExecutor* InProcessExecutor = Cast<UMoviePipelineInProcessExecutor>(ActiveExecutor);
+	if (InProcessExecutor != nullptr)
+	{
+		InProcessExecutor->bUseCurrentLevel = true;
+	}
 
-	// Assign rendering finished callback
+	// Assign rendering finished callback before starting, as executors can finish synchronously
 	ActiveExecutor->OnExecutorFinished().AddUObject(this, &USequenceRenderer::OnExecutorFinished);
+
+	// Keep recording outputs while rendering, so that little work is lost if the rendering gets interrupted
+	ExpectCurrentOutputs();
+	ManifestTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &USequenceRenderer::OnManifestFlushTick),
+		ManifestFlushIntervalSeconds);
+
+	// Run the rendering
+	MoviePipelineQueueSubsystem->RenderQueueWithExecutorInstance(ActiveExecutor);
 }
 
 bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipelineQueueSubsystem)
@@ -440,6 +1020,72 @@ bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipel
 	PngSetting->SetIsEnabled(CurrentTarget->ImageFormat == EImageFormat::PNG);
 	ExrSetting->SetIsEnabled(CurrentTarget->ImageFormat == EImageFormat::EXR);
 
+	// Apply anti-aliasing settings of the target on top of the default ones
+	UMoviePipelineAntiAliasingSetting* AntiAliasingSetting = Cast<UMoviePipelineAntiAliasingSetting>(
+		EasySynthMoviePipelineConfig->FindOrAddSettingByClass(UMoviePipelineAntiAliasingSetting::StaticClass()));
+	if (AntiAliasingSetting == nullptr)
+	{
+		ErrorMessage = "Could not find the anti-aliasing setting inside the default config";
+		return false;
+	}
+	const FAntiAliasingOverrides Overrides = CurrentTarget->AntiAliasingOverrides();
+	AntiAliasingSetting->SpatialSampleCount =
+		Overrides.SpatialSampleCount.Get(DefaultAntiAliasing.SpatialSampleCount.GetValue());
+	AntiAliasingSetting->TemporalSampleCount =
+		Overrides.TemporalSampleCount.Get(DefaultAntiAliasing.TemporalSampleCount.GetValue());
+	AntiAliasingSetting->EngineWarmUpCount =
+		Overrides.EngineWarmUpCount.Get(DefaultAntiAliasing.EngineWarmUpCount.GetValue());
+	AntiAliasingSetting->RenderWarmUpCount =
+		Overrides.RenderWarmUpCount.Get(DefaultAntiAliasing.RenderWarmUpCount.GetValue());
+	const TOptional<EAntiAliasingMethod> AntiAliasingMethod = Overrides.AntiAliasingMethod.IsSet() ?
+		Overrides.AntiAliasingMethod :
+		DefaultAntiAliasing.AntiAliasingMethod;
+	AntiAliasingSetting->bOverrideAntiAliasing = AntiAliasingMethod.IsSet();
+	if (AntiAliasingMethod.IsSet())
+	{
+		AntiAliasingSetting->AntiAliasingMethod = AntiAliasingMethod.GetValue();
+	}
+
+	// Multi-pass targets are rendered as additional post process passes, without the main pass
+	const TArray<UMaterialInterface*> PassMaterials = CurrentTarget->PassMaterials();
+	const bool bMultiPass = PassMaterials.Num() > 0;
+
+	// Update the deferred pass setting to render the requested passes
+	UMoviePipelineDeferredPassBase* DeferredPassSetting =
+		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineDeferredPassBase>();
+	if (DeferredPassSetting == nullptr)
+	{
+		ErrorMessage = "Could not find the deferred pass setting inside the default config";
+		return false;
+	}
+	DeferredPassSetting->bRenderMainPass = !bMultiPass;
+	DeferredPassSetting->AdditionalPostProcessMaterials.Empty();
+	for (UMaterialInterface* PassMaterial : PassMaterials)
+	{
+		FMoviePipelinePostProcessPass PostProcessPass;
+		PostProcessPass.bEnabled = true;
+		PostProcessPass.Material = PassMaterial;
+		DeferredPassSetting->AdditionalPostProcessMaterials.Add(PostProcessPass);
+	}
+
+	// Write a separate file for each pass, so that each target keeps its own output directory,
+	// containing only the channels the target carries
+	UMoviePipelineImageSequenceOutput_EXRLocal* ExrOutputSetting = Cast<UMoviePipelineImageSequenceOutput_EXRLocal>(ExrSetting);
+	ExrOutputSetting->bMultilayer = !bMultiPass;
+	ExrOutputSetting->PassChannelSchemas = CurrentTarget->ExrPassChannelSchemas();
+	ExrOutputSetting->PassCompressions = CurrentTarget->ExrPassCompressions();
+
+	// Render all camera components of the camera cut actor when all rig cameras share the job
+	const bool bAllRigCameras = CurrentRigCameraId == FRenderWorkItem::AllRigCameras;
+	UMoviePipelineCameraSetting* CameraSetting = Cast<UMoviePipelineCameraSetting>(
+		EasySynthMoviePipelineConfig->FindOrAddSettingByClass(UMoviePipelineCameraSetting::StaticClass()));
+	if (CameraSetting == nullptr)
+	{
+		ErrorMessage = "Could not find the camera setting inside the default config";
+		return false;
+	}
+	CameraSetting->bRenderAllCameras = bAllRigCameras;
+
 	// Update pipeline output settings for the current target
 	UMoviePipelineOutputSetting* OutputSetting =
 		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineOutputSetting>();
@@ -449,9 +1095,30 @@ bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipel
 		return false;
 	}
 	// Update the image output directory
-	OutputSetting->OutputDirectory.Path =
-		FPathUtils::RigCameraDir(RenderingDirectory, RigCameras[CurrentRigCameraId]) / CurrentTarget->Name();
-	OutputSetting->OutputResolution = OutputResolution;
+	// The movie pipeline names rendered cameras after their components, same as rig camera directories
+	const FString RigCameraDir = bAllRigCameras ?
+		RenderingDirectory / TEXT("{camera_name}") :
+		FPathUtils::RigCameraDir(RenderingDirectory, RigCameras[CurrentRigCameraId]);
+	if (bMultiPass)
+	{
+		// Passes are named after their targets, which places each of them inside its target directory
+		OutputSetting->OutputDirectory.Path = RigCameraDir;
+		OutputSetting->FileNameFormat = FString(TEXT("{render_pass}")) / DefaultFileNameFormat;
+	}
+	else
+	{
+		OutputSetting->OutputDirectory.Path = RigCameraDir / CurrentTarget->Name();
+		OutputSetting->FileNameFormat = DefaultFileNameFormat;
+	}
+	OutputSetting->OutputResolution = CurrentTarget->OutputResolution(OutputResolution);
+
+	// Render only the part of the sequence covered by the work item
+	OutputSetting->bUseCustomPlaybackRange = CurrentStartFrame > 0 || CurrentEndFrame < SequenceFrameCount;
+	OutputSetting->CustomStartFrame = SequenceStartFrame + CurrentStartFrame;
+	OutputSetting->CustomEndFrame = SequenceStartFrame + CurrentEndFrame;
+
+	// Skip frames between the selected ones, counted from the start of the custom range
+	OutputSetting->OutputFrameStep = CurrentFrameStep;
 
 	// Get the queue of sequences to be renderer
 	UMoviePipelineQueue* MoviePipelineQueue = MoviePipelineQueueSubsystem->GetQueue();
@@ -507,8 +1174,12 @@ void USequenceRenderer::BroadcastRenderingFinished(const bool bSuccess)
 		RigCameras[0]->SetFieldOfView(OriginalCameraFOV);
 	}
 
+	FTSTicker::GetCoreTicker().RemoveTicker(ManifestTickerHandle);
+	RenderManifest.Flush(true);
+
 	RigCameras.Empty();
-	TargetsQueue.Empty();
+	WorkQueue.Empty();
+	CurrentTarget = nullptr;
 
 	// Revert world state to the original one
 	TextureStyleManager->CheckoutTextureStyle(OriginalTextureStyle);
@@ -2,22 +2,31 @@
 
 #include "SequencerWrapper.h"
 
+#include "Camera/CameraComponent.h"
+#include "Editor.h"
 #include "ILevelSequenceEditorToolkit.h"
 #include "ISequencer.h"
 #include "LevelSequence.h"
 #include "MovieScene.h"
+#include "MovieSceneCommonHelpers.h"
 #include "Sections/MovieSceneCameraCutSection.h"
 #include "Subsystems/AssetEditorSubsystem.h"
 
+#include "EasySynth.h"
+
 
 bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 {
+	WeakLevelSequence = LevelSequence;
+	WeakSequencer.Reset();
+	ErrorMessage.Empty();
+
 	// Get the root level sequence movie scene
 	MovieScene = LevelSequence->GetMovieScene();
 	if (MovieScene == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not get the movie scene from the level sequence"),
-			*FString(__FUNCTION__))
+		ErrorMessage = "Could not get the movie scene from the level sequence";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
@@ -25,19 +34,36 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 	CameraCutTrack = MovieScene->GetCameraCutTrack();
 	if (CameraCutTrack == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not get the camera cut track from the movie scene"),
-			*FString(__FUNCTION__))
+		ErrorMessage = "Could not get the camera cut track from the movie scene";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
 	GetMovieSceneCutSections();
 
+	// Commandlets have no editor UI, so bindings are resolved directly inside the editor world,
+	// which cannot spawn the actors of spawnable bindings
+	if (IsRunningCommandlet())
+	{
+		for (UMovieSceneCameraCutSection* CutSection : MovieSceneCutSections)
+		{
+			if (MovieScene->FindSpawnable(CutSection->GetCameraBindingID().GetGuid()) != nullptr)
+			{
+				ErrorMessage = "Spawnable cameras are not supported by the commandlet, bind a camera rig placed in the level";
+				UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+				return false;
+			}
+		}
+		return true;
+	}
+
 	// Open sequencer editor for the level sequence asset
 	TArray<UObject*> Assets;
 	Assets.Add(LevelSequence);
 	if (!GEditor->GetEditorSubsystem<UAssetEditorSubsystem>()->OpenEditorForAssets(Assets))
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not open the level sequence editor"), *FString(__FUNCTION__))
+		ErrorMessage = "Could not open the level sequence editor";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
@@ -46,7 +72,8 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 		GEditor->GetEditorSubsystem<UAssetEditorSubsystem>()->FindEditorForAsset(LevelSequence, false);
 	if (AssetEditor == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not find the asset editor"), *FString(__FUNCTION__))
+		ErrorMessage = "Could not find the asset editor";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
@@ -54,7 +81,8 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 	ILevelSequenceEditorToolkit* LevelSequenceEditor = static_cast<ILevelSequenceEditorToolkit*>(AssetEditor);
 	if (LevelSequenceEditor == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not find the level sequence editor"), *FString(__FUNCTION__))
+		ErrorMessage = "Could not find the level sequence editor";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
@@ -62,13 +90,64 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 	WeakSequencer = LevelSequenceEditor ? LevelSequenceEditor->GetSequencer() : nullptr;
 	if (!WeakSequencer.IsValid())
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not get the sequencer"), *FString(__FUNCTION__))
+		ErrorMessage = "Could not get the sequencer";
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
 	return true;
 }
 
+TArray<UObject*> FSequencerWrapper::FindBoundObjects(const FGuid& BindingGuid)
+{
+	TArray<UObject*> BoundObjects;
+	if (!WeakLevelSequence.IsValid())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: The level sequence is not opened"), *FString(__FUNCTION__))
+		return BoundObjects;
+	}
+
+	// The sequencer also resolves spawnable bindings, by spawning their actors
+	if (WeakSequencer.IsValid())
+	{
+		TSharedPtr<ISequencer> Sequencer = WeakSequencer.Pin();
+		for (TWeakObjectPtr<> BoundObject : Sequencer->FindBoundObjects(BindingGuid, Sequencer->GetFocusedTemplateID()))
+		{
+			if (BoundObject.IsValid())
+			{
+				BoundObjects.Add(BoundObject.Get());
+			}
+		}
+		return BoundObjects;
+	}
+
+	// Possessed level actors are resolved inside the editor world, the same way the sequence player does it
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	TArray<UObject*, TInlineAllocator<1>> LocatedObjects;
+	WeakLevelSequence->LocateBoundObjects(BindingGuid, World, LocatedObjects);
+	BoundObjects.Append(LocatedObjects);
+	return BoundObjects;
+}
+
+UCameraComponent* FSequencerWrapper::GetCutSectionCamera(UMovieSceneCameraCutSection* CutSection)
+{
+	if (WeakSequencer.IsValid())
+	{
+		TSharedPtr<ISequencer> Sequencer = WeakSequencer.Pin();
+		return CutSection->GetFirstCamera(*Sequencer, Sequencer->GetFocusedTemplateID());
+	}
+
+	for (UObject* BoundObject : FindBoundObjects(CutSection->GetCameraBindingID().GetGuid()))
+	{
+		UCameraComponent* Camera = MovieSceneHelpers::CameraComponentFromRuntimeObject(BoundObject);
+		if (Camera != nullptr)
+		{
+			return Camera;
+		}
+	}
+	return nullptr;
+}
+
 TArray<UMovieSceneCameraCutSection*>& FSequencerWrapper::GetMovieSceneCutSections()
 {
 	MovieSceneCutSections.Empty();
@@ -0,0 +1,228 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "RenderJob.h"
+#include "RenderPlanner.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Renderer target that only carries a name and a texture style, so that work can be planned without a level */
+class FStubRendererTarget : public FRendererTarget
+{
+public:
+	FStubRendererTarget(const FString& TargetName, const ETextureStyle TargetTextureStyle) :
+		FRendererTarget(nullptr, EImageFormat::PNG),
+		TargetName(TargetName),
+		TargetTextureStyle(TargetTextureStyle)
+	{}
+
+	FString Name() const override { return TargetName; }
+
+	bool PrepareSequence(ULevelSequence* LevelSequence) override { return true; }
+
+	bool FinalizeSequence(ULevelSequence* LevelSequence) override { return true; }
+
+	ETextureStyle TextureStyle() const override { return TargetTextureStyle; }
+
+private:
+	FString TargetName;
+
+	ETextureStyle TargetTextureStyle;
+};
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FRenderJobParsingTest,
+	"EasySynth.RenderJob.Parsing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FRenderJobParsingTest::RunTest(const FString& Parameters)
+{
+	FEasySynthRenderJob RenderJob;
+	FRendererTargetOptions RendererTargetOptions;
+	FString ErrorMessage;
+
+	const FString ValidJob = TEXT(R"({
+		"Sequence": "/Game/Sequences/MySequence.MySequence",
+		"Targets": [
+			{ "Name": "ColorImage", "Format": "jpeg" },
+			{ "Name": "DepthImage", "Format": "exr", "ResolutionScale": 0.5 },
+			{ "Name": "InstanceImage", "Format": "exr", "Compression": "ZIPS" }
+		],
+		"bTargetMajorOrder": true,
+		"ShardIndex": 1,
+		"ShardCount": 4,
+		"FrameStride": 2,
+		"OutputDirectory": "D:/EasySynthOutput"
+	})");
+	TestTrue(TEXT("Valid job is parsed"), FEasySynthRenderJob::LoadFromString(ValidJob, RenderJob, ErrorMessage));
+	TestTrue(TEXT("Valid job is converted"), RenderJob.ToRendererTargetOptions(RendererTargetOptions, ErrorMessage));
+	TestTrue(TEXT("Color selected"), RendererTargetOptions.TargetSelected(FRendererTargetOptions::COLOR_IMAGE));
+	TestTrue(TEXT("Depth selected"), RendererTargetOptions.TargetSelected(FRendererTargetOptions::DEPTH_IMAGE));
+	TestFalse(TEXT("Normal not selected"), RendererTargetOptions.TargetSelected(FRendererTargetOptions::NORMAL_IMAGE));
+	TestEqual(TEXT("Depth format"),
+		RendererTargetOptions.OutputFormat(FRendererTargetOptions::DEPTH_IMAGE), EImageFormat::EXR);
+	TestEqual(TEXT("Depth resolution scale"),
+		RendererTargetOptions.ResolutionScale(FRendererTargetOptions::DEPTH_IMAGE), 0.5f);
+	TestTrue(TEXT("Target major order"), RendererTargetOptions.TargetMajorOrder());
+	TestEqual(TEXT("Shard index"), RendererTargetOptions.ShardIndex(), 1);
+	TestEqual(TEXT("Frame stride"), RendererTargetOptions.FrameStride(), 2);
+	TestEqual(TEXT("Output directory"), RenderJob.OutputDirectory, FString(TEXT("D:/EasySynthOutput")));
+
+	// Jobs that can't be rendered are rejected with an error message
+	const TArray<FString> InvalidJobs = {
+		TEXT(R"({ "Targets": [ { "Name": "ColorImage" } ] })"),
+		TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [] })"),
+		TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [ { "Name": "ColorImage" } ], "ShardIndex": 2, "ShardCount": 2 })"),
+		TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [ { "Name": "ColorImage" } ], "OutputImageResolution": { "X": 0, "Y": 1080 } })"),
+		TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [ { "Name": "ColorImage" } ], "FrameRangeStart": 100, "FrameRangeEnd": 50 })"),
+		TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [ { "Name": "ColorImage" } ], "FrameRangeStart": 100 })"),
+		TEXT("not a json"),
+	};
+	for (const FString& InvalidJob : InvalidJobs)
+	{
+		ErrorMessage.Empty();
+		TestFalse(FString::Printf(TEXT("Invalid job rejected: %s"), *InvalidJob),
+			FEasySynthRenderJob::LoadFromString(InvalidJob, RenderJob, ErrorMessage));
+		TestFalse(TEXT("Error message set"), ErrorMessage.IsEmpty());
+	}
+
+	// Jobs with unknown targets, formats or compressions, or lossy compressions of IDs, are parsed, but can't be converted into options
+	const TArray<FString> InvalidTargets = {
+		TEXT(R"({ "Name": "FooImage" })"),
+		TEXT(R"({ "Name": "ColorImage", "Format": "bmp" })"),
+		TEXT(R"({ "Name": "DepthImage", "Format": "exr", "Compression": "FOO" })"),
+		TEXT(R"({ "Name": "InstanceImage", "Format": "exr", "Compression": "DWAA" })"),
+		TEXT(R"({ "Name": "SemanticImage", "Format": "exr", "Compression": "B44" })"),
+	};
+	for (const FString& InvalidTarget : InvalidTargets)
+	{
+		const FString Job = FString::Printf(TEXT(R"({ "Sequence": "/Game/MySequence", "Targets": [ %s ] })"), *InvalidTarget);
+		ErrorMessage.Empty();
+		TestTrue(TEXT("Job with an invalid target is parsed"), FEasySynthRenderJob::LoadFromString(Job, RenderJob, ErrorMessage));
+		TestFalse(FString::Printf(TEXT("Invalid target rejected: %s"), *InvalidTarget),
+			RenderJob.ToRendererTargetOptions(RendererTargetOptions, ErrorMessage));
+		TestFalse(TEXT("Error message set"), ErrorMessage.IsEmpty());
+	}
+
+	// Only the [0, 0) frame range falls back to shards, other empty ranges are rejected
+	FRendererTargetOptions FrameRangeOptions;
+	TestTrue(TEXT("No frame range valid"), FrameRangeOptions.FrameSelectionValid());
+	FrameRangeOptions.SetFrameRange(0, 50);
+	TestTrue(TEXT("Range from the sequence start valid"), FrameRangeOptions.FrameSelectionValid());
+	FrameRangeOptions.SetFrameRange(100, 50);
+	TestFalse(TEXT("Inverted range rejected"), FrameRangeOptions.FrameSelectionValid());
+	FrameRangeOptions.SetFrameRange(100, 100);
+	TestFalse(TEXT("Empty range after the sequence start rejected"), FrameRangeOptions.FrameSelectionValid());
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FRenderPlannerTest,
+	"EasySynth.RenderPlanner.PlanWork",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FRenderPlannerTest::RunTest(const FString& Parameters)
+{
+	const TArray<TSharedPtr<FRendererTarget>> Targets = {
+		MakeShared<FStubRendererTarget>(TEXT("Semantic"), ETextureStyle::SEMANTIC),
+		MakeShared<FStubRendererTarget>(TEXT("Color"), ETextureStyle::COLOR),
+		MakeShared<FStubRendererTarget>(TEXT("Depth"), ETextureStyle::COLOR),
+	};
+	const int RigCameraCount = 3;
+	TArray<FRenderWorkItem> WorkItems;
+
+	// Target major order renders each target with all cameras, starting with targets of the current style
+	FRenderPlanner::PlanWork(Targets, RigCameraCount, true, false, ETextureStyle::COLOR, 0, 100, WorkItems);
+	if (TestEqual(TEXT("Target major work item count"), WorkItems.Num(), Targets.Num() * RigCameraCount))
+	{
+		TestEqual(TEXT("Current style first"), WorkItems[0].Target->Name(), FString(TEXT("Color")));
+		TestEqual(TEXT("Cameras follow each other"), WorkItems[1].RigCameraId, 1);
+		TestEqual(TEXT("Target order kept within a style"), WorkItems[RigCameraCount].Target->Name(), FString(TEXT("Depth")));
+		TestEqual(TEXT("Other style last"), WorkItems.Last().Target->Name(), FString(TEXT("Semantic")));
+		TestEqual(TEXT("Whole range covered"), WorkItems.Last().EndFrame, 100);
+	}
+
+	// Camera major order continues with the style the previous camera ended with
+	FRenderPlanner::PlanWork(Targets, RigCameraCount, false, false, ETextureStyle::COLOR, 0, 100, WorkItems);
+	if (TestEqual(TEXT("Camera major work item count"), WorkItems.Num(), Targets.Num() * RigCameraCount))
+	{
+		TestEqual(TEXT("First camera ends with the other style"), WorkItems[2].Target->Name(), FString(TEXT("Semantic")));
+		TestEqual(TEXT("Second camera starts with the same style"), WorkItems[3].Target->Name(), FString(TEXT("Semantic")));
+		TestEqual(TEXT("Second camera"), WorkItems[3].RigCameraId, 1);
+	}
+
+	// All rig cameras share a single job per target
+	FRenderPlanner::PlanWork(Targets, RigCameraCount, false, true, ETextureStyle::COLOR, 0, 100, WorkItems);
+	if (TestEqual(TEXT("All rig cameras work item count"), WorkItems.Num(), Targets.Num()))
+	{
+		TestEqual(TEXT("All rig cameras"), WorkItems[0].RigCameraId, FRenderWorkItem::AllRigCameras);
+	}
+
+	// Frame selection keeps every stride-th frame inside the range
+	TBitArray<> SelectedFrames;
+	FRenderPlanner::SelectFrames(TArray<FTransform>(), 10, 20, 3, 0.0f, 0.0f, SelectedFrames);
+	TestTrue(TEXT("Range start selected"), SelectedFrames[10]);
+	TestFalse(TEXT("Frame between strides skipped"), SelectedFrames[11]);
+	TestTrue(TEXT("Stride frame selected"), SelectedFrames[19]);
+	TestFalse(TEXT("Frame before the range skipped"), SelectedFrames[9]);
+
+	// Evenly spaced frames are rendered by a single work item
+	const FRenderWorkItem WorkItem = WorkItems[0];
+	FRenderPlanner::SplitIntoRuns(WorkItem, { 10, 13, 16, 19 }, WorkItems);
+	if (TestEqual(TEXT("Evenly spaced frames share a work item"), WorkItems.Num(), 1))
+	{
+		TestEqual(TEXT("Run start"), WorkItems[0].StartFrame, 10);
+		TestEqual(TEXT("Run end"), WorkItems[0].EndFrame, 20);
+		TestEqual(TEXT("Run step"), WorkItems[0].FrameStep, 3);
+	}
+
+	// Dense irregular frames are merged into fewer work items that still render all of them
+	TArray<int> IrregularFrames;
+	for (const int ClusterStart : { 0, 10000 })
+	{
+		for (int Frame = 0; Frame < 300; Frame += (Frame % 7 == 0) ? 2 : 3)
+		{
+			IrregularFrames.Add(ClusterStart + Frame);
+		}
+	}
+	const int ExtraFrames = FRenderPlanner::SplitIntoRuns(WorkItem, IrregularFrames, WorkItems);
+	int RenderedFrames = 0;
+	for (const int Frame : IrregularFrames)
+	{
+		const bool bFrameRendered = WorkItems.ContainsByPredicate([Frame](const FRenderWorkItem& Run)
+		{
+			return Frame >= Run.StartFrame && Frame < Run.EndFrame && (Frame - Run.StartFrame) % Run.FrameStep == 0;
+		});
+		TestTrue(FString::Printf(TEXT("Frame %d rendered"), Frame), bFrameRendered);
+	}
+	for (const FRenderWorkItem& Run : WorkItems)
+	{
+		RenderedFrames += (Run.EndFrame - Run.StartFrame - 1) / Run.FrameStep + 1;
+	}
+	TestEqual(TEXT("Extra frames counted"), ExtraFrames, RenderedFrames - IrregularFrames.Num());
+
+	// Merging the two clusters would render thousands of frames in between to save a single job
+	if (TestEqual(TEXT("Each cluster merged into its own work item"), WorkItems.Num(), 2))
+	{
+		TestEqual(TEXT("First cluster end"), WorkItems[0].EndFrame, 300);
+		TestEqual(TEXT("Second cluster start"), WorkItems[1].StartFrame, 10000);
+	}
+
+	// Sparse frames keep their runs, instead of being collapsed into a run rendering every frame
+	FRenderPlanner::SplitIntoRuns(WorkItem, { 0, 1000, 2003, 3010, 4021 }, WorkItems);
+	if (TestEqual(TEXT("Sparse runs kept apart"), WorkItems.Num(), 3))
+	{
+		TestEqual(TEXT("First sparse run step"), WorkItems[0].FrameStep, 1000);
+		TestEqual(TEXT("Second sparse run step"), WorkItems[1].FrameStep, 1007);
+		TestEqual(TEXT("Single frame run start"), WorkItems[2].StartFrame, 4021);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
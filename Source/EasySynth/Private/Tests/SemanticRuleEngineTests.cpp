@@ -0,0 +1,95 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "TextureStyles/SemanticRuleEngine.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FSemanticRuleCompilationTest,
+	"EasySynth.SemanticRuleEngine.CompileRules",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSemanticRuleCompilationTest::RunTest(const FString& Parameters)
+{
+	FSemanticRuleEngine SemanticRuleEngine;
+	FSemanticRuleSet RuleSet;
+	FString ErrorMessage;
+
+	FSemanticRule& PrefixRule = RuleSet.Rules.AddDefaulted_GetRef();
+	PrefixRule.Class = TEXT("Car");
+	PrefixRule.Property = TEXT("Label");
+	PrefixRule.Match = TEXT("Prefix");
+	PrefixRule.Pattern = TEXT("SM_Car");
+	FSemanticRule& RegexRule = RuleSet.Rules.AddDefaulted_GetRef();
+	RegexRule.Class = TEXT("Tree");
+	RegexRule.Property = TEXT("Mesh");
+	RegexRule.Match = TEXT("Regex");
+	RegexRule.Pattern = TEXT("Tree_\\d+$");
+	TestTrue(TEXT("Valid rules compile"), SemanticRuleEngine.CompileRules(RuleSet, ErrorMessage));
+
+	// Invalid regular expressions are rejected before any actor is matched against them
+	RuleSet.Rules[1].Pattern = TEXT("Tree_(\\d+");
+	TestFalse(TEXT("Invalid regular expression rejected"), SemanticRuleEngine.CompileRules(RuleSet, ErrorMessage));
+	TestTrue(TEXT("Error names the rule"), ErrorMessage.StartsWith(TEXT("Rule 1 ")));
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FSemanticRulePrecedenceTest,
+	"EasySynth.SemanticRuleEngine.Precedence",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSemanticRulePrecedenceTest::RunTest(const FString& Parameters)
+{
+	FSemanticRuleEngine SemanticRuleEngine;
+	FSemanticRuleSet RuleSet;
+	FString ErrorMessage;
+
+	// Rules of different match types are listed in an order that differs from the order they are evaluated in
+	const TArray<TTuple<FString, FString, FString>> Rules = {
+		{ TEXT("Car"), TEXT("Regex"), TEXT("^SM_Car_\\d+$") },
+		{ TEXT("Prop"), TEXT("Prefix"), TEXT("SM_") },
+		{ TEXT("SpecialCar"), TEXT("Exact"), TEXT("SM_Car_01") },
+		{ TEXT("Tree"), TEXT("Exact"), TEXT("Tree") },
+		{ TEXT("Plant"), TEXT("Regex"), TEXT("Tree") },
+	};
+	for (const TTuple<FString, FString, FString>& Rule : Rules)
+	{
+		FSemanticRule& SemanticRule = RuleSet.Rules.AddDefaulted_GetRef();
+		SemanticRule.Class = Rule.Get<0>();
+		SemanticRule.Property = TEXT("Label");
+		SemanticRule.Match = Rule.Get<1>();
+		SemanticRule.Pattern = Rule.Get<2>();
+	}
+	if (!TestTrue(TEXT("Rules compile"), SemanticRuleEngine.CompileRules(RuleSet, ErrorMessage)))
+	{
+		return false;
+	}
+
+	// The first matching rule wins, whatever its match type
+	TestEqual(TEXT("Regex before prefix and exact"),
+		SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("SM_Car_01")), FString(TEXT("Car")));
+	TestEqual(TEXT("Prefix"), SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("SM_Lamp")), FString(TEXT("Prop")));
+	TestEqual(TEXT("Exact before regex"),
+		SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("Tree")), FString(TEXT("Tree")));
+	TestEqual(TEXT("Unanchored regex"),
+		SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("PineTree")), FString(TEXT("Plant")));
+
+	// All match types are case-sensitive
+	TestEqual(TEXT("Case-sensitive exact and regex"),
+		SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("tree")), FString());
+	TestEqual(TEXT("Case-sensitive prefix"),
+		SemanticRuleEngine.FindMatchingClass(TEXT("Label"), TEXT("sm_Lamp")), FString());
+
+	// Rules only match the property they were written for
+	TestEqual(TEXT("Other property"), SemanticRuleEngine.FindMatchingClass(TEXT("Tag"), TEXT("Tree")), FString());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,109 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "CineCameraActor.h"
+#include "Editor.h"
+#include "LevelSequence.h"
+#include "Misc/AutomationTest.h"
+#include "MovieScene.h"
+#include "Subsystems/AssetEditorSubsystem.h"
+#include "Tracks/MovieSceneCameraCutTrack.h"
+
+#include "SequenceRenderer.h"
+#include "Tests/StubMoviePipelineExecutor.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+int UStubMoviePipelineExecutor::ExecutionCount = 0;
+int UStubMoviePipelineExecutor::ExecutedJobCount = 0;
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FSequenceRendererExecutorTest,
+	"EasySynth.SequenceRenderer.Executor",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSequenceRendererExecutorTest::RunTest(const FString& Parameters)
+{
+	// Camera placed in the level and bound to a sequence of 10 frames through a single camera cut
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	ACineCameraActor* CameraActor = World->SpawnActor<ACineCameraActor>();
+	ULevelSequence* LevelSequence = NewObject<ULevelSequence>(GetTransientPackage(), NAME_None, RF_Transient);
+	LevelSequence->Initialize();
+	UMovieScene* MovieScene = LevelSequence->GetMovieScene();
+	MovieScene->SetDisplayRate(FFrameRate(10, 1));
+	MovieScene->SetPlaybackRange(TRange<FFrameNumber>(
+		FFrameNumber(0),
+		FFrameRate::TransformTime(FFrameTime(10), MovieScene->GetDisplayRate(), MovieScene->GetTickResolution()).FloorToFrame()));
+	const FGuid CameraGuid = MovieScene->AddPossessable(CameraActor->GetActorLabel(), CameraActor->GetClass());
+	LevelSequence->BindPossessableObject(CameraGuid, *CameraActor, World);
+	UMovieSceneCameraCutTrack* CameraCutTrack = CastChecked<UMovieSceneCameraCutTrack>(
+		MovieScene->AddCameraCutTrack(UMovieSceneCameraCutTrack::StaticClass()));
+	CameraCutTrack->AddNewCameraCut(UE::MovieScene::FRelativeObjectBindingID(CameraGuid), FFrameNumber(0));
+
+	UTextureStyleManager* TextureStyleManager = NewObject<UTextureStyleManager>();
+	TextureStyleManager->AddToRoot();
+	USequenceRenderer* SequenceRenderer = NewObject<USequenceRenderer>();
+	SequenceRenderer->AddToRoot();
+	SequenceRenderer->SetTextureStyleManager(TextureStyleManager);
+	SequenceRenderer->SetExecutorClass(UStubMoviePipelineExecutor::StaticClass());
+
+	// Render two targets without waiting for the editor, so that the second work item
+	// is prepared from inside the finished callback of the synchronously finished first one
+	FRendererTargetOptions RendererTargetOptions;
+	RendererTargetOptions.SetSelectedTarget(FRendererTargetOptions::COLOR_IMAGE, true);
+	RendererTargetOptions.SetSelectedTarget(FRendererTargetOptions::DEPTH_IMAGE, true);
+	RendererTargetOptions.SetMaxReadinessWaitSeconds(0.0f);
+
+	TSharedRef<int> FinishedEventCount = MakeShared<int>(0);
+	TSharedRef<bool> bRenderingSucceeded = MakeShared<bool>(false);
+	SequenceRenderer->OnRenderingFinished().AddLambda([FinishedEventCount, bRenderingSucceeded](bool bSuccess)
+	{
+		(*FinishedEventCount)++;
+		*bRenderingSucceeded = bSuccess;
+	});
+
+	UStubMoviePipelineExecutor::ExecutionCount = 0;
+	UStubMoviePipelineExecutor::ExecutedJobCount = 0;
+	const bool bRenderingStarted = SequenceRenderer->RenderSequence(
+		LevelSequence,
+		RendererTargetOptions,
+		FIntPoint(64, 64),
+		FPaths::AutomationTransientDir() / TEXT("EasySynthSequenceRenderer"));
+	TestTrue(TEXT("Rendering started"), bRenderingStarted);
+
+	// Work items are started by editor world timers, so the editor has to tick until the rendering finishes
+	auto Cleanup = [World, CameraActor, LevelSequence, TextureStyleManager, SequenceRenderer]()
+	{
+		GEditor->GetEditorSubsystem<UAssetEditorSubsystem>()->CloseAllEditorsForAsset(LevelSequence);
+		World->DestroyActor(CameraActor);
+		SequenceRenderer->RemoveFromRoot();
+		TextureStyleManager->RemoveFromRoot();
+	};
+	const float TimeoutSeconds = 30.0f;
+	ADD_LATENT_AUTOMATION_COMMAND(FUntilCommand(
+		[this, SequenceRenderer, FinishedEventCount, bRenderingSucceeded, Cleanup]()
+		{
+			if (SequenceRenderer->IsRendering())
+			{
+				return false;
+			}
+			TestEqual(TEXT("Finished event broadcast once"), *FinishedEventCount, 1);
+			TestTrue(TEXT("Rendering succeeded"), *bRenderingSucceeded);
+			TestEqual(TEXT("Stub executor used for each target"), UStubMoviePipelineExecutor::ExecutionCount, 2);
+			TestEqual(TEXT("Single job queued each time"), UStubMoviePipelineExecutor::ExecutedJobCount, 2);
+			Cleanup();
+			return true;
+		},
+		[this, Cleanup]()
+		{
+			AddError(TEXT("Rendering with the stub executor did not finish"));
+			Cleanup();
+			return true;
+		},
+		TimeoutSeconds));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,38 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoviePipelineExecutor.h"
+#include "MoviePipelineQueue.h"
+
+#include "StubMoviePipelineExecutor.generated.h"
+
+
+/**
+ * Movie pipeline executor that renders nothing and finishes synchronously
+ * inside Execute, used by tests to drive the sequence renderer without a renderer
+*/
+UCLASS(Transient)
+class UStubMoviePipelineExecutor : public UMoviePipelineExecutorBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Records the executed queue and finishes right away */
+	void Execute_Implementation(UMoviePipelineQueue* InPipelineQueue) override
+	{
+		ExecutionCount++;
+		ExecutedJobCount += InPipelineQueue->GetJobs().Num();
+		OnExecutorFinishedImpl();
+	}
+
+	/** The executor never keeps rendering after Execute returns */
+	bool IsRendering_Implementation() const override { return false; }
+
+	/** Number of times any stub executor was executed */
+	static int ExecutionCount;
+
+	/** Number of jobs inside all executed queues */
+	static int ExecutedJobCount;
+};
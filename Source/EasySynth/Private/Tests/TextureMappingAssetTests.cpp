@@ -0,0 +1,65 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreRedirects.h"
+#include "UObject/UnrealType.h"
+
+#include "TextureStyles/TextureMappingAsset.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FTextureMappingAssetMigrationTest,
+	"EasySynth.TextureMappingAsset.Migration",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FTextureMappingAssetMigrationTest::RunTest(const FString& Parameters)
+{
+	// Properties of older asset versions are loaded into the deprecated properties of the same types
+	const FName ClassesName = FCoreRedirects::GetRedirectedName(
+		ECoreRedirectFlags::Type_Property,
+		FCoreRedirectObjectName(TEXT("SemanticClasses"), TEXT("TextureMappingAsset"), TEXT("/Script/EasySynth"))).ObjectName;
+	const FName ActorClassesName = FCoreRedirects::GetRedirectedName(
+		ECoreRedirectFlags::Type_Property,
+		FCoreRedirectObjectName(TEXT("ActorClassPairs"), TEXT("TextureMappingAsset"), TEXT("/Script/EasySynth"))).ObjectName;
+	FMapProperty* ClassesProperty = FindFProperty<FMapProperty>(UTextureMappingAsset::StaticClass(), ClassesName);
+	FMapProperty* ActorClassesProperty = FindFProperty<FMapProperty>(UTextureMappingAsset::StaticClass(), ActorClassesName);
+	if (!TestNotNull(TEXT("Old classes are redirected"), ClassesProperty) ||
+		!TestNotNull(TEXT("Old actor bindings are redirected"), ActorClassesProperty))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Old classes keep name keys"), ClassesProperty->KeyProp->IsA<FStrProperty>());
+	TestTrue(TEXT("Old actor bindings keep name values"), ActorClassesProperty->ValueProp->IsA<FStrProperty>());
+
+	// Fill the redirected properties the way loading an older asset does
+	UTextureMappingAsset* Asset = NewObject<UTextureMappingAsset>();
+	const FString ClassName(TEXT("Car"));
+	FSemanticClass OldClass;
+	OldClass.Name = ClassName;
+	OldClass.Color = FColor::Red;
+	FScriptMapHelper ClassesHelper(ClassesProperty, ClassesProperty->ContainerPtrToValuePtr<void>(Asset));
+	ClassesHelper.AddPair(&ClassName, &OldClass);
+
+	const FGuid ActorGuid = FGuid::NewGuid();
+	FScriptMapHelper ActorClassesHelper(ActorClassesProperty, ActorClassesProperty->ContainerPtrToValuePtr<void>(Asset));
+	ActorClassesHelper.AddPair(&ActorGuid, &ClassName);
+
+	Asset->PostLoad();
+
+	const uint16 ClassId = Asset->FindClassId(ClassName);
+	TestNotEqual(TEXT("Class migrated"), ClassId, UTextureMappingAsset::InvalidClassId);
+	FSemanticClass* MigratedClass = Asset->FindClass(ClassId);
+	if (TestNotNull(TEXT("Migrated class found by its ID"), MigratedClass))
+	{
+		TestTrue(TEXT("Class color kept"), MigratedClass->Color == FColor::Red);
+	}
+	TestEqual(TEXT("Actor binding migrated"), Asset->FindActorClassId(ActorGuid), ClassId);
+	TestEqual(TEXT("Old classes cleared"), ClassesHelper.Num(), 0);
+	TestEqual(TEXT("Old actor bindings cleared"), ActorClassesHelper.Num(), 0);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,116 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "TextureStyles/InstanceIdManager.h"
+
+#include "Misc/FileHelper.h"
+
+#include "EasySynth.h"
+#include "PathUtils.h"
+#include "TextureStyles/TextureMappingAsset.h"
+
+
+const uint32 UInstanceIdManager::BackgroundInstanceId = 0;
+const uint32 UInstanceIdManager::FirstInstanceId = 1;
+const uint32 UInstanceIdManager::MaxInstanceId = 0xFFFFFF;
+
+void UInstanceIdManager::AssignInstanceIds(const TArray<AActor*>& Actors)
+{
+	TArray<FGuid> NewActorGuids;
+	for (AActor* Actor : Actors)
+	{
+		if (!InstanceIds.Contains(Actor->GetActorGuid()))
+		{
+			NewActorGuids.Add(Actor->GetActorGuid());
+		}
+	}
+
+	// Sorting makes IDs independent of the order actors are stored in
+	NewActorGuids.Sort();
+	InstanceIds.Reserve(InstanceIds.Num() + NewActorGuids.Num());
+	for (const FGuid& ActorGuid : NewActorGuids)
+	{
+		AssignInstanceId(ActorGuid);
+	}
+}
+
+uint32 UInstanceIdManager::FindInstanceId(const FGuid& ActorGuid) const
+{
+	const uint32* InstanceId = InstanceIds.Find(ActorGuid);
+	return InstanceId != nullptr ? *InstanceId : BackgroundInstanceId;
+}
+
+FColor UInstanceIdManager::ActorColor(AActor* Actor)
+{
+	uint32 InstanceId = FindInstanceId(Actor->GetActorGuid());
+	if (InstanceId == BackgroundInstanceId)
+	{
+		InstanceId = AssignInstanceId(Actor->GetActorGuid());
+	}
+	return InstanceColor(InstanceId);
+}
+
+bool UInstanceIdManager::ExportInstances(
+	const FString& OutputDir,
+	const TArray<AActor*>& Actors,
+	UTextureMappingAsset* TextureMappingAsset) const
+{
+	TArray<TPair<uint32, AActor*>> SortedActors;
+	SortedActors.Reserve(Actors.Num());
+	for (AActor* Actor : Actors)
+	{
+		const uint32 InstanceId = FindInstanceId(Actor->GetActorGuid());
+		if (InstanceId != BackgroundInstanceId)
+		{
+			SortedActors.Emplace(InstanceId, Actor);
+		}
+	}
+	SortedActors.Sort([](const TPair<uint32, AActor*>& A, const TPair<uint32, AActor*>& B) { return A.Key < B.Key; });
+
+	TArray<FString> Lines;
+	Lines.Reserve(SortedActors.Num() + 1);
+	Lines.Add("id,r,g,b,guid,class");
+	for (const TPair<uint32, AActor*>& Element : SortedActors)
+	{
+		const FColor Color = InstanceColor(Element.Key);
+		const FSemanticClass* SemanticClass =
+			TextureMappingAsset->FindClass(TextureMappingAsset->FindActorClassId(Element.Value->GetActorGuid()));
+		Lines.Add(FString::Printf(TEXT("%u,%d,%d,%d,%s,%s"),
+			Element.Key, Color.R, Color.G, Color.B,
+			*Element.Value->GetActorGuid().ToString(),
+			SemanticClass != nullptr ? *SemanticClass->Name : TEXT("")));
+	}
+
+	// Save the file
+	const FString SaveFilePath = FPathUtils::InstancesFilePath(OutputDir);
+	if (!FFileHelper::SaveStringArrayToFile(
+		Lines,
+		*SaveFilePath,
+		FFileHelper::EEncodingOptions::AutoDetect,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_None))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *SaveFilePath)
+		return false;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Exported %d instances"), *FString(__FUNCTION__), SortedActors.Num())
+
+	return true;
+}
+
+FColor UInstanceIdManager::InstanceColor(const uint32 InstanceId)
+{
+	return FColor(InstanceId & 0xFF, (InstanceId >> 8) & 0xFF, (InstanceId >> 16) & 0xFF, 255);
+}
+
+uint32 UInstanceIdManager::AssignInstanceId(const FGuid& ActorGuid)
+{
+	if (NextInstanceId > MaxInstanceId)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: All %u instance IDs are taken"), *FString(__FUNCTION__), MaxInstanceId)
+		return BackgroundInstanceId;
+	}
+
+	InstanceIds.Add(ActorGuid, NextInstanceId);
+	return NextInstanceId++;
+}
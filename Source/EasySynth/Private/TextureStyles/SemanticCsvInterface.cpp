@@ -57,41 +57,69 @@ FReply FSemanticCsvInterface::OnImportSemanticClassesClicked(UTextureStyleManage
 		}
 	}
 
-	TextureStyleManager->RemoveAllSemanticCLasses();
+	// Classes are applied only if the whole file is valid
+	TArray<FSemanticClass> SemanticClasses;
+	FString ErrorMessage;
+	if (!ParseSemanticClasses(FileContent, SemanticClasses, ErrorMessage) ||
+		!TextureStyleManager->ImportSemanticClasses(SemanticClasses, ErrorMessage))
+	{
+		const FText MessageBoxTitle = LOCTEXT("InvalidCsvMessageBoxTitle", "Failed to load CSV");
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(ErrorMessage), &MessageBoxTitle);
+	}
+
+	return FReply::Handled();
+}
+
+bool FSemanticCsvInterface::ImportSemanticClasses(
+	const FString& FilePath,
+	UTextureStyleManager* TextureStyleManager,
+	FString& OutErrorMessage)
+{
+	FString FileContent;
+	if (!FFileHelper::LoadFileToString(FileContent, *FilePath))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Could not read the semantic classes file %s"), *FilePath);
+		return false;
+	}
 
-	// Parse the file contents
+	TArray<FSemanticClass> SemanticClasses;
+	return
+		ParseSemanticClasses(FileContent, SemanticClasses, OutErrorMessage) &&
+		TextureStyleManager->ImportSemanticClasses(SemanticClasses, OutErrorMessage);
+}
+
+bool FSemanticCsvInterface::ParseSemanticClasses(
+	const FString& FileContent,
+	TArray<FSemanticClass>& OutSemanticClasses,
+	FString& OutErrorMessage)
+{
 	const FCsvParser CsvParser(FileContent);
 	const FCsvParser::FRows& Rows = CsvParser.GetRows();
 
+	OutSemanticClasses.Reset(Rows.Num());
 	for (int i = 0; i < Rows.Num(); i++)
 	{
 		const TArray<const TCHAR*>& Row = Rows[i];
-
 		if (Row.Num() != 4)
 		{
-			const FText MessageBoxTitle = LOCTEXT("InvalidCsvMessageBoxTitle", "Failed to load CSV");
-			FMessageDialog::Open(
-				EAppMsgType::Ok,
-				LOCTEXT("InvalidCsvMessageBoxText", "Expected line format \"name, R, G, B\""),
-				&MessageBoxTitle);
-			return FReply::Handled();
+			OutErrorMessage = FString::Printf(TEXT("Expected line format \"name, R, G, B\" in line %d"), i + 1);
+			return false;
 		}
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), Row[0])
 
-		const bool bSaveTextureMappingAsset = (i == Rows.Num() - 1);
-		TextureStyleManager->NewSemanticClass(Row[0],
-			FColor(FCString::Atoi(Row[1]), FCString::Atoi(Row[2]), FCString::Atoi(Row[3])),
-			bSaveTextureMappingAsset);
+		FSemanticClass& SemanticClass = OutSemanticClasses.AddDefaulted_GetRef();
+		SemanticClass.Name = Row[0];
+		SemanticClass.Color = FColor(FCString::Atoi(Row[1]), FCString::Atoi(Row[2]), FCString::Atoi(Row[3]));
 	}
 
-	return FReply::Handled();
+	return true;
 }
 
 bool FSemanticCsvInterface::ExportSemanticClasses(const FString& OutputDir, UTextureMappingAsset* TextureMappingAsset)
 {
 	TArray<FString> Lines;
 
-	for (auto Element : TextureMappingAsset->SemanticClasses)
+	for (const auto& Element : TextureMappingAsset->Classes())
 	{
 		const FSemanticClass& Class = Element.Value;
 		Lines.Add(FString::Printf(TEXT("%s,%d,%d,%d"), *Class.Name, Class.Color.R, Class.Color.G, Class.Color.B));
@@ -0,0 +1,348 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "TextureStyles/SemanticRuleEngine.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/StaticMeshComponent.h"
+#include "DesktopPlatformModule.h"
+#include "IDesktopPlatform.h"
+#include "JsonObjectConverter.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#if UE_ENABLE_ICU
+THIRD_PARTY_INCLUDES_START
+#include <unicode/regex.h>
+THIRD_PARTY_INCLUDES_END
+#endif
+
+#include "EasySynth.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+#define LOCTEXT_NAMESPACE "FSemanticRuleEngine"
+
+const TMap<FString, FSemanticRuleEngine::EActorProperty> FSemanticRuleEngine::ActorPropertyNames = {
+	{ TEXT("Label"), LABEL },
+	{ TEXT("Tag"), TAG },
+	{ TEXT("Folder"), FOLDER },
+	{ TEXT("Mesh"), MESH },
+	{ TEXT("Component"), COMPONENT },
+};
+
+FReply FSemanticRuleEngine::OnApplySemanticRulesClicked(UTextureStyleManager* TextureStyleManager)
+{
+	UE_LOG(LogEasySynth, Log, TEXT("%s"), *FString(__FUNCTION__))
+
+	// Get desktop platform
+	void* ParentWindowPtr = FSlateApplication::Get().GetActiveTopLevelWindow()->GetNativeWindow()->GetOSWindowHandle();
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not get the desktop platform"), *FString(__FUNCTION__))
+		return FReply::Handled();
+	}
+
+	// Display file open dialog
+	TArray<FString> OutFilenames;
+	const bool IsFileSelected = DesktopPlatform->OpenFileDialog(
+		ParentWindowPtr,
+		TEXT("Apply semantic rules"),
+		TEXT(""),
+		TEXT(""),
+		TEXT("Semantic Rules JSON (*.json)|*.json"),
+		EFileDialogFlags::None,
+		OutFilenames);
+	if (!IsFileSelected)
+	{
+		return FReply::Handled();
+	}
+
+	FString ErrorMessage;
+	if (!LoadRules(OutFilenames[0], ErrorMessage) || !ApplyRules(TextureStyleManager, ErrorMessage))
+	{
+		const FText MessageBoxTitle = LOCTEXT("ApplyRulesFailedMessageBoxTitle", "Failed to apply semantic rules");
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(ErrorMessage), &MessageBoxTitle);
+	}
+
+	return FReply::Handled();
+}
+
+bool FSemanticRuleEngine::LoadRules(const FString& FilePath, FString& OutErrorMessage)
+{
+	FString FileContent;
+	if (!FFileHelper::LoadFileToString(FileContent, *FilePath))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Could not read the semantic rules file %s"), *FilePath);
+		return false;
+	}
+
+	FSemanticRuleSet RuleSet;
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(FileContent, &RuleSet, 0, 0))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Invalid semantic rules file content %s"), *FilePath);
+		return false;
+	}
+
+	return CompileRules(RuleSet, OutErrorMessage);
+}
+
+bool FSemanticRuleEngine::CompileRules(const FSemanticRuleSet& RuleSet, FString& OutErrorMessage)
+{
+	for (int i = 0; i < ACTOR_PROPERTY_COUNT; i++)
+	{
+		PropertyMatchers[i] = FPropertyMatcher();
+	}
+	RuleClassNames.Reset();
+
+	for (int RuleIndex = 0; RuleIndex < RuleSet.Rules.Num(); RuleIndex++)
+	{
+		const FSemanticRule& Rule = RuleSet.Rules[RuleIndex];
+
+		const EActorProperty* ActorProperty = ActorPropertyNames.Find(Rule.Property);
+		if (ActorProperty == nullptr)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Rule %d matches unknown actor property '%s'"),
+				RuleIndex, *Rule.Property);
+			return false;
+		}
+
+		FPropertyMatcher& PropertyMatcher = PropertyMatchers[*ActorProperty];
+		if (Rule.Match == TEXT("Exact"))
+		{
+			PropertyMatcher.AddExactRule(Rule.Pattern, RuleIndex);
+		}
+		else if (Rule.Match == TEXT("Prefix"))
+		{
+			PropertyMatcher.AddPrefixRule(Rule.Pattern, RuleIndex);
+		}
+		else if (Rule.Match == TEXT("Regex"))
+		{
+			// Invalid patterns have to be rejected here, as matching them would fail while evaluating actors
+			FString RegexErrorMessage;
+			if (!ValidateRegex(Rule.Pattern, RegexErrorMessage))
+			{
+				OutErrorMessage = FString::Printf(TEXT("Rule %d uses the invalid regular expression '%s': %s"),
+					RuleIndex, *Rule.Pattern, *RegexErrorMessage);
+				return false;
+			}
+			PropertyMatcher.AddRegexRule(Rule.Pattern, RuleIndex);
+		}
+		else
+		{
+			OutErrorMessage = FString::Printf(TEXT("Rule %d uses unknown match type '%s'"), RuleIndex, *Rule.Match);
+			return false;
+		}
+
+		RuleClassNames.Add(Rule.Class);
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Compiled %d semantic rules"), *FString(__FUNCTION__), RuleClassNames.Num())
+
+	return true;
+}
+
+bool FSemanticRuleEngine::ApplyRules(UTextureStyleManager* TextureStyleManager, FString& OutErrorMessage) const
+{
+	// Make sure all rule classes exist before any actor is modified
+	const TArray<FString> ClassNames = TextureStyleManager->SemanticClassNames();
+	for (int RuleIndex = 0; RuleIndex < RuleClassNames.Num(); RuleIndex++)
+	{
+		if (!ClassNames.Contains(RuleClassNames[RuleIndex]))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Rule %d assigns unknown semantic class '%s'"),
+				RuleIndex, *RuleClassNames[RuleIndex]);
+			return false;
+		}
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Actor properties are read on the game thread
+	TArray<AActor*> LevelActors;
+	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
+	LevelActors.RemoveAll([](AActor* Actor){ return Actor->HasAnyFlags(RF_Transient); });
+	TArray<FActorProperties> ActorProperties;
+	ActorProperties.SetNum(LevelActors.Num());
+	for (int i = 0; i < LevelActors.Num(); i++)
+	{
+		CollectActorProperties(LevelActors[i], ActorProperties[i]);
+	}
+
+	// Matching only reads the compiled rules and collected values, so actors are evaluated in parallel
+	TArray<int32> ActorRuleIndices;
+	ActorRuleIndices.SetNum(LevelActors.Num());
+	ParallelFor(LevelActors.Num(), [&](const int32 ActorIndex)
+	{
+		int32 FirstRuleIndex = RuleClassNames.Num();
+		for (int Property = 0; Property < ACTOR_PROPERTY_COUNT; Property++)
+		{
+			for (const FString& Value : ActorProperties[ActorIndex].Values[Property])
+			{
+				FirstRuleIndex = PropertyMatchers[Property].FirstMatchingRule(Value, FirstRuleIndex);
+			}
+		}
+		ActorRuleIndices[ActorIndex] = FirstRuleIndex;
+	});
+
+	// Apply all matches in a single batch
+	TMap<AActor*, FString> ActorClassNames;
+	for (int i = 0; i < LevelActors.Num(); i++)
+	{
+		if (ActorRuleIndices[i] < RuleClassNames.Num())
+		{
+			ActorClassNames.Add(LevelActors[i], RuleClassNames[ActorRuleIndices[i]]);
+		}
+	}
+	const int UpdatedActorCount = TextureStyleManager->ApplySemanticClassesToActors(ActorClassNames);
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: %d of %d actors matched, %d updated in %.3f s"),
+		*FString(__FUNCTION__), ActorClassNames.Num(), LevelActors.Num(), UpdatedActorCount,
+		FPlatformTime::Seconds() - StartSeconds)
+
+	return true;
+}
+
+FString FSemanticRuleEngine::FindMatchingClass(const FString& PropertyName, const FString& Value) const
+{
+	const EActorProperty* ActorProperty = ActorPropertyNames.Find(PropertyName);
+	if (ActorProperty == nullptr)
+	{
+		return FString();
+	}
+
+	const int32 RuleIndex = PropertyMatchers[*ActorProperty].FirstMatchingRule(Value, RuleClassNames.Num());
+	return RuleIndex < RuleClassNames.Num() ? RuleClassNames[RuleIndex] : FString();
+}
+
+void FSemanticRuleEngine::CollectActorProperties(AActor* Actor, FActorProperties& OutProperties)
+{
+	OutProperties.Values[LABEL].Add(Actor->GetActorLabel());
+
+	for (const FName& Tag : Actor->Tags)
+	{
+		OutProperties.Values[TAG].Add(Tag.ToString());
+	}
+
+	OutProperties.Values[FOLDER].Add(Actor->GetFolderPath().ToString());
+
+	TArray<UActorComponent*> ActorComponents;
+	Actor->GetComponents(ActorComponents);
+	for (UActorComponent* ActorComponent : ActorComponents)
+	{
+		OutProperties.Values[COMPONENT].AddUnique(ActorComponent->GetClass()->GetName());
+
+		UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(ActorComponent);
+		if (StaticMeshComponent != nullptr && StaticMeshComponent->GetStaticMesh() != nullptr)
+		{
+			OutProperties.Values[MESH].AddUnique(StaticMeshComponent->GetStaticMesh()->GetPathName());
+		}
+	}
+}
+
+bool FSemanticRuleEngine::ValidateRegex(const FString& Pattern, FString& OutErrorMessage)
+{
+#if UE_ENABLE_ICU
+	// FRegexPattern does not report compilation errors, so the pattern is compiled by ICU directly
+	const FTCHARToUTF16 UTF16Pattern(*Pattern);
+	const icu::UnicodeString ICUPattern(reinterpret_cast<const UChar*>(UTF16Pattern.Get()), UTF16Pattern.Length());
+	UParseError ParseError;
+	UErrorCode ICUStatus = U_ZERO_ERROR;
+	TUniquePtr<icu::RegexPattern> ICURegexPattern(icu::RegexPattern::compile(ICUPattern, ParseError, ICUStatus));
+	if (U_FAILURE(ICUStatus))
+	{
+		OutErrorMessage = FString::Printf(TEXT("%s at offset %d"), UTF8_TO_TCHAR(u_errorName(ICUStatus)), ParseError.offset);
+		return false;
+	}
+#endif
+	return true;
+}
+
+FSemanticRuleEngine::FPropertyMatcher::FPropertyMatcher()
+{
+	// Add the root node
+	PrefixTrie.AddDefaulted();
+}
+
+void FSemanticRuleEngine::FPropertyMatcher::AddExactRule(const FString& Pattern, const int32 RuleIndex)
+{
+	// Rules are added in order, so an existing rule with the same pattern takes precedence
+	if (!ExactRules.Contains(Pattern))
+	{
+		ExactRules.Add(Pattern, RuleIndex);
+	}
+}
+
+void FSemanticRuleEngine::FPropertyMatcher::AddPrefixRule(const FString& Pattern, const int32 RuleIndex)
+{
+	int32 NodeIndex = 0;
+	for (const TCHAR Character : Pattern)
+	{
+		const int32* ChildIndex = PrefixTrie[NodeIndex].Children.Find(Character);
+		if (ChildIndex != nullptr)
+		{
+			NodeIndex = *ChildIndex;
+			continue;
+		}
+
+		// The trie array can be reallocated, so the parent node is looked up again
+		const int32 NewNodeIndex = PrefixTrie.AddDefaulted();
+		PrefixTrie[NodeIndex].Children.Add(Character, NewNodeIndex);
+		NodeIndex = NewNodeIndex;
+	}
+
+	if (PrefixTrie[NodeIndex].RuleIndex == INDEX_NONE)
+	{
+		PrefixTrie[NodeIndex].RuleIndex = RuleIndex;
+	}
+}
+
+void FSemanticRuleEngine::FPropertyMatcher::AddRegexRule(const FString& Pattern, const int32 RuleIndex)
+{
+	RegexRules.Emplace(FRegexPattern(Pattern), RuleIndex);
+}
+
+int32 FSemanticRuleEngine::FPropertyMatcher::FirstMatchingRule(const FString& Value, int32 FirstRuleIndex) const
+{
+	const int32* ExactRuleIndex = ExactRules.Find(Value);
+	if (ExactRuleIndex != nullptr)
+	{
+		FirstRuleIndex = FMath::Min(FirstRuleIndex, *ExactRuleIndex);
+	}
+
+	// Walk the trie along the value, every node on the way ends a matching prefix
+	int32 NodeIndex = 0;
+	for (int i = 0; NodeIndex != INDEX_NONE; i++)
+	{
+		const FPrefixTrieNode& Node = PrefixTrie[NodeIndex];
+		if (Node.RuleIndex != INDEX_NONE)
+		{
+			FirstRuleIndex = FMath::Min(FirstRuleIndex, Node.RuleIndex);
+		}
+		if (i == Value.Len())
+		{
+			break;
+		}
+		const int32* ChildIndex = Node.Children.Find(Value[i]);
+		NodeIndex = ChildIndex != nullptr ? *ChildIndex : INDEX_NONE;
+	}
+
+	// Regular expressions are the most expensive, so only those that can still take precedence are evaluated
+	for (const TPair<FRegexPattern, int32>& RegexRule : RegexRules)
+	{
+		if (RegexRule.Value >= FirstRuleIndex)
+		{
+			break;
+		}
+		FRegexMatcher RegexMatcher(RegexRule.Key, Value);
+		if (RegexMatcher.FindNext())
+		{
+			FirstRuleIndex = RegexRule.Value;
+			break;
+		}
+	}
+
+	return FirstRuleIndex;
+}
+
+#undef LOCTEXT_NAMESPACE
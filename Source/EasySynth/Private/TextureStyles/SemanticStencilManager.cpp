@@ -0,0 +1,250 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "TextureStyles/SemanticStencilManager.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/PostProcessVolume.h"
+#include "Engine/Texture2D.h"
+#include "HAL/IConsoleManager.h"
+#include "MaterialEditingLibrary.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionAdd.h"
+#include "Materials/MaterialExpressionAppendVector.h"
+#include "Materials/MaterialExpressionComponentMask.h"
+#include "Materials/MaterialExpressionConstant.h"
+#include "Materials/MaterialExpressionDivide.h"
+#include "Materials/MaterialExpressionSceneTexture.h"
+#include "Materials/MaterialExpressionTextureSample.h"
+
+#include "EasySynth.h"
+#include "TextureStyles/TextureMappingAsset.h"
+
+
+const int USemanticStencilManager::LookupTextureSize = 256;
+const int USemanticStencilManager::StencilValueCount = 256;
+
+void USemanticStencilManager::UpdateSemanticClasses(const TMap<uint16, FSemanticClass>& SemanticClasses)
+{
+	// Primitives without a class remain black
+	StencilColors.Init(FColor::Black, StencilValueCount);
+	for (const TPair<uint16, FSemanticClass>& Element : SemanticClasses)
+	{
+		if (Element.Key >= StencilValueCount)
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: ID of the semantic class '%s' does not fit into the stencil"),
+				*FString(__FUNCTION__), *Element.Value.Name)
+			continue;
+		}
+		StencilColors[Element.Key] = Element.Value.Color;
+	}
+
+	UpdateLookupTexture();
+}
+
+void USemanticStencilManager::PaintActor(AActor* Actor, const uint16 ClassId)
+{
+	// Classes that do not fit into the stencil were reported when the classes were updated,
+	// their primitives are displayed as primitives without a class instead of keeping a stale value
+	const int32 StencilValue = ClassId < StencilValueCount ? ClassId : 0;
+
+	TArray<UActorComponent*> ActorComponents;
+	const bool bIncludeFromChildActors = true;
+	Actor->GetComponents(UPrimitiveComponent::StaticClass(), ActorComponents, bIncludeFromChildActors);
+	for (UActorComponent* ActorComponent : ActorComponents)
+	{
+		UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(ActorComponent);
+		if (PrimitiveComponent == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Got null primitive component"), *FString(__FUNCTION__))
+			return;
+		}
+
+		// Repainting a primitive keeps the settings it had before it was painted for the first time
+		if (!OriginalStencils.Contains(PrimitiveComponent))
+		{
+			FStencilBackup& StencilBackup = OriginalStencils.Add(PrimitiveComponent);
+			StencilBackup.bRenderCustomDepth = PrimitiveComponent->bRenderCustomDepth;
+			StencilBackup.CustomDepthStencilValue = PrimitiveComponent->CustomDepthStencilValue;
+		}
+
+		// Setters only update the render state if the value changes
+		PrimitiveComponent->SetRenderCustomDepth(true);
+		PrimitiveComponent->SetCustomDepthStencilValue(StencilValue);
+	}
+}
+
+void USemanticStencilManager::RestoreOriginalStencils()
+{
+	// Primitives destroyed in the meantime need nothing restored
+	for (const TPair<TWeakObjectPtr<UPrimitiveComponent>, FStencilBackup>& Element : OriginalStencils)
+	{
+		UPrimitiveComponent* PrimitiveComponent = Element.Key.Get();
+		if (PrimitiveComponent != nullptr)
+		{
+			PrimitiveComponent->SetRenderCustomDepth(Element.Value.bRenderCustomDepth);
+			PrimitiveComponent->SetCustomDepthStencilValue(Element.Value.CustomDepthStencilValue);
+		}
+	}
+	OriginalStencils.Empty();
+
+	if (OriginalCustomDepthMode != INDEX_NONE)
+	{
+		IConsoleVariable* CustomDepthVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("r.CustomDepth"));
+		if (CustomDepthVariable != nullptr)
+		{
+			CustomDepthVariable->Set(OriginalCustomDepthMode, ECVF_SetByCode);
+		}
+		OriginalCustomDepthMode = INDEX_NONE;
+	}
+}
+
+UMaterial* USemanticStencilManager::GetPostProcessMaterial()
+{
+	if (PostProcessMaterial == nullptr && !CreatePostProcessMaterial())
+	{
+		return nullptr;
+	}
+	return PostProcessMaterial;
+}
+
+void USemanticStencilManager::SetEditorViewEnabled(const bool bEnabled)
+{
+	if (!bEnabled)
+	{
+		if (EditorViewVolume.IsValid())
+		{
+			EditorViewVolume->Destroy();
+		}
+		EditorViewVolume.Reset();
+		return;
+	}
+
+	// The volume is gone together with the world it was spawned in
+	if (EditorViewVolume.IsValid())
+	{
+		return;
+	}
+
+	UMaterial* Material = GetPostProcessMaterial();
+	if (Material == nullptr)
+	{
+		return;
+	}
+
+	// Spawn a transient volume that affects all editor viewports and is never saved with the level
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	SpawnParameters.bHideFromSceneOutliner = true;
+	APostProcessVolume* Volume =
+		GEditor->GetEditorWorldContext().World()->SpawnActor<APostProcessVolume>(SpawnParameters);
+	if (Volume == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not spawn the post process volume"), *FString(__FUNCTION__))
+		return;
+	}
+	Volume->bUnbound = true;
+	Volume->Settings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, Material));
+	EditorViewVolume = Volume;
+}
+
+void USemanticStencilManager::EnableCustomDepthStencil()
+{
+	// Value 3 enables custom depth together with stencil values
+	IConsoleVariable* CustomDepthVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("r.CustomDepth"));
+	if (CustomDepthVariable != nullptr && CustomDepthVariable->GetInt() != 3)
+	{
+		if (OriginalCustomDepthMode == INDEX_NONE)
+		{
+			OriginalCustomDepthMode = CustomDepthVariable->GetInt();
+		}
+		CustomDepthVariable->Set(3, ECVF_SetByCode);
+	}
+}
+
+bool USemanticStencilManager::CreatePostProcessMaterial()
+{
+	// Raw texel values are needed, so the texture is neither filtered nor gamma corrected
+	LookupTexture = UTexture2D::CreateTransient(LookupTextureSize, LookupTextureSize, PF_B8G8R8A8);
+	if (LookupTexture == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the lookup texture"), *FString(__FUNCTION__))
+		return false;
+	}
+	LookupTexture->SRGB = false;
+	LookupTexture->Filter = TF_Nearest;
+	LookupTexture->AddressX = TA_Clamp;
+	LookupTexture->AddressY = TA_Clamp;
+	UpdateLookupTexture();
+
+	// The material replaces the tonemapper, so class colors are written to output images unchanged
+	PostProcessMaterial = NewObject<UMaterial>(this, TEXT("M_PPSemanticStencil"), RF_Transient);
+	PostProcessMaterial->MaterialDomain = EMaterialDomain::MD_PostProcess;
+	PostProcessMaterial->BlendableLocation = EBlendableLocation::BL_ReplacingTonemapper;
+
+	// Stencil value of the pixel
+	UMaterialExpressionSceneTexture* SceneTexture = Cast<UMaterialExpressionSceneTexture>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionSceneTexture::StaticClass()));
+	SceneTexture->SceneTextureId = ESceneTextureId::PPI_CustomStencil;
+	UMaterialExpressionComponentMask* StencilMask = Cast<UMaterialExpressionComponentMask>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionComponentMask::StaticClass()));
+	StencilMask->R = true;
+	StencilMask->G = false;
+	StencilMask->B = false;
+	StencilMask->A = false;
+	UMaterialEditingLibrary::ConnectMaterialExpressions(SceneTexture, TEXT("Color"), StencilMask, TEXT(""));
+
+	// Center of the texel that corresponds to the stencil value, inside the first texture row
+	UMaterialExpressionAdd* TexelCenter = Cast<UMaterialExpressionAdd>(
+		UMaterialEditingLibrary::CreateMaterialExpression(PostProcessMaterial, UMaterialExpressionAdd::StaticClass()));
+	TexelCenter->ConstB = 0.5f;
+	UMaterialEditingLibrary::ConnectMaterialExpressions(StencilMask, TEXT(""), TexelCenter, TEXT("A"));
+	UMaterialExpressionDivide* TexelU = Cast<UMaterialExpressionDivide>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionDivide::StaticClass()));
+	TexelU->ConstB = LookupTextureSize;
+	UMaterialEditingLibrary::ConnectMaterialExpressions(TexelCenter, TEXT(""), TexelU, TEXT("A"));
+	UMaterialExpressionConstant* TexelV = Cast<UMaterialExpressionConstant>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionConstant::StaticClass()));
+	TexelV->R = 0.5f / LookupTextureSize;
+	UMaterialExpressionAppendVector* TexelUV = Cast<UMaterialExpressionAppendVector>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionAppendVector::StaticClass()));
+	UMaterialEditingLibrary::ConnectMaterialExpressions(TexelU, TEXT(""), TexelUV, TEXT("A"));
+	UMaterialEditingLibrary::ConnectMaterialExpressions(TexelV, TEXT(""), TexelUV, TEXT("B"));
+
+	// Class color of the stencil value
+	UMaterialExpressionTextureSample* ClassColor = Cast<UMaterialExpressionTextureSample>(
+		UMaterialEditingLibrary::CreateMaterialExpression(
+			PostProcessMaterial, UMaterialExpressionTextureSample::StaticClass()));
+	ClassColor->Texture = LookupTexture;
+	ClassColor->SamplerType = SAMPLERTYPE_LinearColor;
+	UMaterialEditingLibrary::ConnectMaterialExpressions(TexelUV, TEXT(""), ClassColor, TEXT("UVs"));
+	UMaterialEditingLibrary::ConnectMaterialProperty(ClassColor, TEXT("RGB"), MP_EmissiveColor);
+
+	UMaterialEditingLibrary::RecompileMaterial(PostProcessMaterial);
+
+	return true;
+}
+
+void USemanticStencilManager::UpdateLookupTexture()
+{
+	if (LookupTexture == nullptr)
+	{
+		// The texture is updated once it is created
+		return;
+	}
+
+	FTexture2DMipMap& Mip = LookupTexture->GetPlatformData()->Mips[0];
+	FColor* Texels = static_cast<FColor*>(Mip.BulkData.Lock(LOCK_READ_WRITE));
+	FMemory::Memzero(Texels, LookupTextureSize * LookupTextureSize * sizeof(FColor));
+	for (int StencilValue = 0; StencilValue < StencilColors.Num(); StencilValue++)
+	{
+		Texels[StencilValue] = StencilColors[StencilValue];
+		Texels[StencilValue].A = 255;
+	}
+	Mip.BulkData.Unlock();
+	LookupTexture->UpdateResource();
+}
@@ -2,8 +2,13 @@
 
 #include "TextureStyles/TextureBackupManager.h"
 
+#include "Components/PrimitiveComponent.h"
+#include "Editor.h"
+#include "LandscapeInfo.h"
 #include "LandscapeProxy.h"
 
+#include "EasySynth.h"
+
 
 void UTextureBackupManager::AddAndPaint(
 	AActor* Actor,
@@ -15,10 +20,24 @@ void UTextureBackupManager::AddAndPaint(
 	if (LandscapeProxy != nullptr)
 	{
 		AddLandscapeActor(LandscapeProxy, bDoAdd, bDoPaint, Material);
-		return;
+	}
+	else
+	{
+		AddDefaultActor(Actor, bDoAdd, bDoPaint, Material);
 	}
 
-	AddDefaultActor(Actor, bDoAdd, bDoPaint, Material);
+	// Remember the painted material, so that repainting the same one can be skipped
+	if (bDoPaint)
+	{
+		if (Material != nullptr && ContainsActor(Actor))
+		{
+			PaintedMaterials.Add(Actor, Material);
+		}
+		else
+		{
+			PaintedMaterials.Remove(Actor);
+		}
+	}
 }
 
 bool UTextureBackupManager::ContainsActor(AActor* Actor)
@@ -34,6 +53,8 @@ bool UTextureBackupManager::ContainsActor(AActor* Actor)
 
 void UTextureBackupManager::RemoveActor(AActor* Actor)
 {
+	PaintedMaterials.Remove(Actor);
+
 	ALandscapeProxy* LandscapeProxy = Cast<ALandscapeProxy>(Actor);
 	if (LandscapeProxy != nullptr)
 	{
@@ -44,6 +65,98 @@ void UTextureBackupManager::RemoveActor(AActor* Actor)
 	OriginalActorDescriptors.Remove(Actor);
 }
 
+UMaterialInstanceConstant* UTextureBackupManager::PaintedMaterial(AActor* Actor) const
+{
+	UMaterialInstanceConstant* const* Material = PaintedMaterials.Find(Actor);
+	return Material != nullptr ? *Material : nullptr;
+}
+
+void UTextureBackupManager::PaintPrimitiveColor(AActor* Actor, const FColor& Color)
+{
+	FOriginalActorDescriptor* ActorDescriptor = OriginalActorDescriptors.Find(Actor);
+	if (ActorDescriptor == nullptr)
+	{
+		return;
+	}
+
+	// Custom primitive data is read by the material as linear color, same as material parameters,
+	// 8-bit images encode it back into the original color, while EXR writers have to do it explicitly
+	const FLinearColor LinearColor(Color);
+	const FVector4 PrimitiveData(LinearColor.R, LinearColor.G, LinearColor.B, 1.0f);
+	for (TPair<UPrimitiveComponent*, FOriginalComponentDescriptor>& Element : ActorDescriptor->CompDescriptors)
+	{
+		UPrimitiveComponent* PrimitiveComponent = Element.Key;
+		if (PrimitiveComponent == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Got null primitive component"), *FString(__FUNCTION__))
+			continue;
+		}
+
+		FOriginalComponentDescriptor& ComponentDescriptor = Element.Value;
+		if (!ComponentDescriptor.bCustomPrimitiveDataStored)
+		{
+			ComponentDescriptor.CustomPrimitiveData = PrimitiveComponent->GetCustomPrimitiveData().Data;
+			ComponentDescriptor.bCustomPrimitiveDataStored = true;
+		}
+		PrimitiveComponent->SetCustomPrimitiveDataVector4(0, PrimitiveData);
+	}
+}
+
+void UTextureBackupManager::UpdatePendingLandscapes()
+{
+	if (PendingLandscapeProxies.Num() == 0)
+	{
+		return;
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Proxies of the same landscape share the landscape info, which rebuilds all of their components at once
+	TSet<ULandscapeInfo*> LandscapeInfos;
+	int UpdatedProxyCount = 0;
+	for (const TWeakObjectPtr<ALandscapeProxy>& LandscapeProxyPtr : PendingLandscapeProxies)
+	{
+		ALandscapeProxy* LandscapeProxy = LandscapeProxyPtr.Get();
+		if (LandscapeProxy == nullptr)
+		{
+			continue;
+		}
+		UpdatedProxyCount++;
+
+		ULandscapeInfo* LandscapeInfo = LandscapeProxy->GetLandscapeInfo();
+		if (LandscapeInfo != nullptr)
+		{
+			LandscapeInfos.Add(LandscapeInfo);
+		}
+		else
+		{
+			// Proxies not registered with any landscape are updated on their own
+			FPropertyChangedEvent PropertyChangedEvent(FindFieldChecked<FProperty>(LandscapeProxy->GetClass(), FName("LandscapeMaterial")));
+			LandscapeProxy->PostEditChangeProperty(PropertyChangedEvent);
+		}
+	}
+	PendingLandscapeProxies.Reset();
+
+	const bool bInvalidateCombinationMaterials = true;
+	for (ULandscapeInfo* LandscapeInfo : LandscapeInfos)
+	{
+		LandscapeInfo->UpdateAllComponentMaterialInstances(bInvalidateCombinationMaterials);
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Updated %d landscape proxies of %d landscapes in %.3f s"),
+		*FString(__FUNCTION__), UpdatedProxyCount, LandscapeInfos.Num(), FPlatformTime::Seconds() - StartSeconds)
+}
+
+void UTextureBackupManager::AddPendingLandscapeProxy(ALandscapeProxy* LandscapeProxy)
+{
+	// Landscapes painted outside of a texture style checkout are updated on the next tick
+	if (PendingLandscapeProxies.Num() == 0)
+	{
+		GEditor->GetTimerManager()->SetTimerForNextTick(this, &UTextureBackupManager::UpdatePendingLandscapes);
+	}
+	PendingLandscapeProxies.Add(LandscapeProxy);
+}
+
 void UTextureBackupManager::AddLandscapeActor(
 	ALandscapeProxy* LandscapeProxy,
 	const bool bDoAdd,
@@ -60,8 +173,7 @@ void UTextureBackupManager::AddLandscapeActor(
 			LandscapeProxy->LandscapeMaterial = Cast<UMaterialInstance>(LandscapeActorDescriptors[LandscapeProxy]);
 			if (LandscapeProxy->LandscapeMaterial != nullptr)
 			{
-				FPropertyChangedEvent PropertyChangedEvent(FindFieldChecked<FProperty>(LandscapeProxy->GetClass(), FName("LandscapeMaterial")));
-				LandscapeProxy->PostEditChangeProperty(PropertyChangedEvent);
+				AddPendingLandscapeProxy(LandscapeProxy);
 				LandscapeActorDescriptors.Remove(LandscapeProxy);
 			}
 			else
@@ -92,8 +204,7 @@ void UTextureBackupManager::AddLandscapeActor(
 			if (MaterialInterface != nullptr)
 			{
 				LandscapeProxy->LandscapeMaterial = MaterialInterface;
-				FPropertyChangedEvent PropertyChangedEvent(FindFieldChecked<FProperty>(LandscapeProxy->GetClass(), FName("LandscapeMaterial")));
-				LandscapeProxy->PostEditChangeProperty(PropertyChangedEvent);
+				AddPendingLandscapeProxy(LandscapeProxy);
 			}
 			else
 			{
@@ -198,6 +309,13 @@ void UTextureBackupManager::AddDefaultActor(
 				}
 			}
 		}
+
+		// Revert the custom primitive data if a color was written into it
+		const FOriginalComponentDescriptor& ComponentDescriptor = OriginalActorDescriptors[Actor][PrimitiveComponent];
+		if (bDoRestore && bDoPaint && ComponentDescriptor.bCustomPrimitiveDataStored)
+		{
+			RestoreCustomPrimitiveData(PrimitiveComponent, ComponentDescriptor.CustomPrimitiveData);
+		}
 	}
 
 	if (bDoRestore)
@@ -205,3 +323,22 @@ void UTextureBackupManager::AddDefaultActor(
 		OriginalActorDescriptors.Remove(Actor);
 	}
 }
+
+void UTextureBackupManager::RestoreCustomPrimitiveData(
+	UPrimitiveComponent* PrimitiveComponent,
+	const TArray<float>& CustomPrimitiveData)
+{
+	// Setters can only grow the data, so the original array, including its length, is written through reflection
+	static const FStructProperty* CustomPrimitiveDataProperty =
+		FindFProperty<FStructProperty>(UPrimitiveComponent::StaticClass(), TEXT("CustomPrimitiveData"));
+	if (CustomPrimitiveDataProperty == nullptr || CustomPrimitiveDataProperty->Struct != FCustomPrimitiveData::StaticStruct())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not find the custom primitive data property"), *FString(__FUNCTION__))
+		return;
+	}
+
+	CustomPrimitiveDataProperty->ContainerPtrToValuePtr<FCustomPrimitiveData>(PrimitiveComponent)->Data = CustomPrimitiveData;
+
+	// Recreate the render proxy, which copies the custom primitive data
+	PrimitiveComponent->MarkRenderStateDirty();
+}
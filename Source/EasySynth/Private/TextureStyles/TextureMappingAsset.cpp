@@ -1,3 +1,198 @@
 // Copyright (c) 2022 YDrive Inc. All rights reserved.
 
 #include "TextureStyles/TextureMappingAsset.h"
+
+#include "UObject/CoreRedirects.h"
+
+#include "EasySynth.h"
+
+
+const uint16 UTextureMappingAsset::InvalidClassId = 0;
+
+void UTextureMappingAsset::PostLoad()
+{
+	Super::PostLoad();
+	RebuildIndices();
+	MigrateClassNames();
+}
+
+void UTextureMappingAsset::RegisterPropertyRedirects()
+{
+	// Name keyed data of older asset versions does not fit the types of the current properties,
+	// so it is loaded into the deprecated properties and migrated after loading
+	TArray<FCoreRedirect> Redirects;
+	Redirects.Emplace(
+		ECoreRedirectFlags::Type_Property,
+		TEXT("/Script/EasySynth.TextureMappingAsset.SemanticClasses"),
+		TEXT("SemanticClasses_DEPRECATED"));
+	Redirects.Emplace(
+		ECoreRedirectFlags::Type_Property,
+		TEXT("/Script/EasySynth.TextureMappingAsset.ActorClassPairs"),
+		TEXT("ActorClassPairs_DEPRECATED"));
+	FCoreRedirects::AddRedirectList(Redirects, TEXT("EasySynth"));
+}
+
+#if WITH_EDITOR
+void UTextureMappingAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	RebuildIndices();
+}
+#endif
+
+FSemanticClass* UTextureMappingAsset::AddClass(const FString& ClassName, const FColor& ClassColor)
+{
+	// Reuse IDs of removed classes to keep IDs compact
+	uint16 ClassId = InvalidClassId + 1;
+	while (SemanticClassesById.Contains(ClassId))
+	{
+		if (ClassId == MAX_uint16)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: No class ID left for the semantic class '%s'"),
+				*FString(__FUNCTION__), *ClassName)
+			return nullptr;
+		}
+		ClassId++;
+	}
+
+	FSemanticClass& SemanticClass = SemanticClassesById.Add(ClassId);
+	SemanticClass.Id = ClassId;
+	SemanticClass.Name = ClassName;
+	SemanticClass.Color = ClassColor;
+	SemanticClass.PlainColorMaterialInstance = nullptr;
+	ClassNameIds.Add(ClassName, ClassId);
+	return &SemanticClass;
+}
+
+void UTextureMappingAsset::RemoveClass(const uint16 ClassId)
+{
+	FSemanticClass SemanticClass;
+	if (SemanticClassesById.RemoveAndCopyValue(ClassId, SemanticClass))
+	{
+		ClassNameIds.Remove(SemanticClass.Name);
+	}
+}
+
+void UTextureMappingAsset::RenameClass(const uint16 ClassId, const FString& NewClassName)
+{
+	FSemanticClass* SemanticClass = SemanticClassesById.Find(ClassId);
+	if (SemanticClass == nullptr)
+	{
+		return;
+	}
+
+	ClassNameIds.Remove(SemanticClass->Name);
+	SemanticClass->Name = NewClassName;
+	ClassNameIds.Add(NewClassName, ClassId);
+}
+
+uint16 UTextureMappingAsset::FindClassId(const FString& ClassName) const
+{
+	const uint16* ClassId = ClassNameIds.Find(ClassName);
+	return ClassId != nullptr ? *ClassId : InvalidClassId;
+}
+
+uint16 UTextureMappingAsset::FindActorClassId(const FGuid& ActorGuid) const
+{
+	const uint16* ClassId = ActorClassIds.Find(ActorGuid);
+	return ClassId != nullptr ? *ClassId : InvalidClassId;
+}
+
+void UTextureMappingAsset::SetActorClass(const FGuid& ActorGuid, const uint16 ClassId)
+{
+	RemoveActor(ActorGuid);
+	ActorClassIds.Add(ActorGuid, ClassId);
+	ClassActorGuids.FindOrAdd(ClassId).Add(ActorGuid);
+}
+
+void UTextureMappingAsset::RemoveActor(const FGuid& ActorGuid)
+{
+	uint16 ClassId;
+	if (!ActorClassIds.RemoveAndCopyValue(ActorGuid, ClassId))
+	{
+		return;
+	}
+
+	TSet<FGuid>* ActorGuids = ClassActorGuids.Find(ClassId);
+	if (ActorGuids != nullptr)
+	{
+		ActorGuids->Remove(ActorGuid);
+		if (ActorGuids->Num() == 0)
+		{
+			ClassActorGuids.Remove(ClassId);
+		}
+	}
+}
+
+const TSet<FGuid>& UTextureMappingAsset::ClassActors(const uint16 ClassId) const
+{
+	static const TSet<FGuid> NoActors;
+	const TSet<FGuid>* ActorGuids = ClassActorGuids.Find(ClassId);
+	return ActorGuids != nullptr ? *ActorGuids : NoActors;
+}
+
+void UTextureMappingAsset::MoveClassActors(const uint16 OldClassId, const uint16 NewClassId)
+{
+	TSet<FGuid> ActorGuids;
+	if (OldClassId == NewClassId || !ClassActorGuids.RemoveAndCopyValue(OldClassId, ActorGuids))
+	{
+		return;
+	}
+
+	for (const FGuid& ActorGuid : ActorGuids)
+	{
+		ActorClassIds[ActorGuid] = NewClassId;
+	}
+	ClassActorGuids.FindOrAdd(NewClassId).Append(ActorGuids);
+}
+
+void UTextureMappingAsset::MigrateClassNames()
+{
+	if (SemanticClasses_DEPRECATED.Num() == 0 && ActorClassPairs_DEPRECATED.Num() == 0)
+	{
+		return;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Assigning IDs to %d semantic classes and %d actors"),
+		*FString(__FUNCTION__), SemanticClasses_DEPRECATED.Num(), ActorClassPairs_DEPRECATED.Num())
+
+	for (const TPair<FString, FSemanticClass>& Element : SemanticClasses_DEPRECATED)
+	{
+		if (FindClassId(Element.Key) == InvalidClassId)
+		{
+			AddClass(Element.Key, Element.Value.Color);
+		}
+	}
+
+	for (const TPair<FGuid, FString>& Element : ActorClassPairs_DEPRECATED)
+	{
+		const uint16 ClassId = FindClassId(Element.Value);
+		if (ClassId == InvalidClassId)
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Actor bound to the unknown semantic class '%s' is left without a class"),
+				*FString(__FUNCTION__), *Element.Value)
+			continue;
+		}
+		SetActorClass(Element.Key, ClassId);
+	}
+
+	// Migrated data is written once the asset is saved again
+	SemanticClasses_DEPRECATED.Empty();
+	ActorClassPairs_DEPRECATED.Empty();
+}
+
+void UTextureMappingAsset::RebuildIndices()
+{
+	ClassNameIds.Reset();
+	for (TPair<uint16, FSemanticClass>& Element : SemanticClassesById)
+	{
+		Element.Value.Id = Element.Key;
+		ClassNameIds.Add(Element.Value.Name, Element.Key);
+	}
+
+	ClassActorGuids.Reset();
+	for (const TPair<FGuid, uint16>& Element : ActorClassIds)
+	{
+		ClassActorGuids.FindOrAdd(Element.Value).Add(Element.Key);
+	}
+}
@@ -4,27 +4,42 @@
 
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Components/StaticMeshComponent.h"
+#include "Editor.h"
 #include "EditorAssetLibrary.h"
 #include "Engine/Selection.h"
-#include "Factories/MaterialInstanceConstantFactoryNew.h"
 #include "FileHelpers.h"
 #include "HAL/FileManagerGeneric.h"
 #include "Kismet/GameplayStatics.h"
+#include "LandscapeProxy.h"
+#include "MaterialEditingLibrary.h"
+#include "Materials/MaterialExpressionVectorParameter.h"
 #include "Materials/MaterialInstanceConstant.h"
+#include "UObject/ObjectSaveContext.h"
 
 #include "PathUtils.h"
+#include "TextureStyles/InstanceIdManager.h"
+#include "TextureStyles/SemanticStencilManager.h"
 #include "TextureStyles/TextureBackupManager.h"
 #include "TextureStyles/TextureMappingAsset.h"
 
 
 const FString UTextureStyleManager::SemanticColorParameter(TEXT("SemanticColor"));
 const FString UTextureStyleManager::UndefinedSemanticClassName(TEXT("Undefined"));
+const float UTextureStyleManager::SaveIntervalSeconds = 5.0f;
 
 UTextureStyleManager::UTextureStyleManager() :
 	PlainColorMaterial(DuplicateObject<UMaterial>(
 		LoadObject<UMaterial>(nullptr, *FPathUtils::PlainColorMaterialPath()), nullptr)),
+	PrimitiveColorMaterial(nullptr),
 	CurrentTextureStyle(ETextureStyle::COLOR),
 	TextureBackupManager(NewObject<UTextureBackupManager>()),
+	SemanticStencilManager(NewObject<USemanticStencilManager>()),
+	InstanceIdManager(NewObject<UInstanceIdManager>()),
+	bSemanticStencilMode(false),
+	bTextureMappingAssetDirty(false),
+	SaveRequestCount(0),
+	SaveCount(0),
+	TotalSaveSeconds(0.0),
 	bEventsBound(false)
 {
 	// Check if the plain color material is loaded correctly
@@ -41,8 +56,23 @@ UTextureStyleManager::UTextureStyleManager() :
 		check(TextureBackupManager)
 	}
 
+	// Check if the SemanticStencilManager is initialized correctly
+	if (SemanticStencilManager == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the SemanticStencilManager"), *FString(__FUNCTION__))
+		check(SemanticStencilManager)
+	}
+
+	// Check if the InstanceIdManager is initialized correctly
+	if (InstanceIdManager == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the InstanceIdManager"), *FString(__FUNCTION__))
+		check(InstanceIdManager)
+	}
+
 	// Prepare the texture mapping asset
 	LoadOrCreateTextureMappingAsset();
+	SemanticStencilManager->UpdateSemanticClasses(TextureMappingAsset->Classes());
 }
 
 void UTextureStyleManager::BindEvents()
@@ -53,6 +83,8 @@ void UTextureStyleManager::BindEvents()
 		GEngine->OnLevelActorAdded().AddUObject(this, &UTextureStyleManager::OnLevelActorAdded);
 		GEngine->OnLevelActorDeleted().AddUObject(this, &UTextureStyleManager::OnLevelActorDeleted);
 		GEngine->OnEditorClose().AddUObject(this, &UTextureStyleManager::OnEditorClose);
+		FEditorDelegates::PreSaveWorldWithContext.AddUObject(this, &UTextureStyleManager::OnPreSaveWorld);
+		FEditorDelegates::PostSaveWorldWithContext.AddUObject(this, &UTextureStyleManager::OnPostSaveWorld);
 		bEventsBound = true;
 	}
 }
@@ -69,7 +101,7 @@ bool UTextureStyleManager::NewSemanticClass(
 	}
 
 	// Check collisions with existing classes
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (auto& Element : TextureMappingAsset->Classes())
 	{
 		const FSemanticClass& SemanticClass = Element.Value;
 		if (SemanticClass.Name == ClassName || SemanticClass.Color == ClassColor)
@@ -83,10 +115,12 @@ bool UTextureStyleManager::NewSemanticClass(
 	}
 
 	// Crate the new class
-	FSemanticClass& NewSemanticClass = TextureMappingAsset->SemanticClasses.Add(ClassName);
-	NewSemanticClass.Name = ClassName;
-	NewSemanticClass.Color = ClassColor;
 	// The semantic class material instance will be created when it's needed
+	if (TextureMappingAsset->AddClass(ClassName, ClassColor) == nullptr)
+	{
+		return false;
+	}
+	SemanticStencilManager->UpdateSemanticClasses(TextureMappingAsset->Classes());
 
 	if (bSaveTextureMappingAsset)
 	{
@@ -101,9 +135,10 @@ bool UTextureStyleManager::NewSemanticClass(
 
 FColor UTextureStyleManager::ClassColor(const FString& ClassName)
 {
-	if (TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const FSemanticClass* SemanticClass = TextureMappingAsset->FindClass(TextureMappingAsset->FindClassId(ClassName));
+	if (SemanticClass != nullptr)
 	{
-		return TextureMappingAsset->SemanticClasses[ClassName].Color;
+		return SemanticClass->Color;
 	}
 	return FColor::White;
 }
@@ -115,14 +150,15 @@ bool UTextureStyleManager::UpdateClassName(const FString& OldClassName, const FS
 		return true;
 	}
 
-	if (!TextureMappingAsset->SemanticClasses.Contains(OldClassName))
+	const uint16 ClassId = TextureMappingAsset->FindClassId(OldClassName);
+	if (ClassId == UTextureMappingAsset::InvalidClassId)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Previous semantic class '%s' not found"),
 			*FString(__FUNCTION__), *OldClassName);
 		return false;
 	}
 
-	if (TextureMappingAsset->SemanticClasses.Contains(NewClassName))
+	if (TextureMappingAsset->FindClassId(NewClassName) != UTextureMappingAsset::InvalidClassId)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: New semantic class '%s' already exists"),
 			*FString(__FUNCTION__), *NewClassName);
@@ -135,69 +171,57 @@ bool UTextureStyleManager::UpdateClassName(const FString& OldClassName, const FS
 		return false;
 	}
 
-	const FColor ClassColor = TextureMappingAsset->SemanticClasses[OldClassName].Color;
-
-	// Remove the existing class
-	TextureMappingAsset->SemanticClasses.Remove(OldClassName);
-	// Add new class with the same color
-	NewSemanticClass(NewClassName, ClassColor);
-	// Update actor mappings to the new semantic class name
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
-	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == OldClassName)
-		{
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] = NewClassName;
-		}
-	}
-	// No action regarding actor materials necessary
+	// Actors are bound to the class ID, so no action regarding actor mappings, stencils or materials is necessary
+	TextureMappingAsset->RenameClass(ClassId, NewClassName);
 
 	SaveTextureMappingAsset();
 
+	// Broadcast the semantic classes change
+	SemanticClassesUpdatedEvent.Broadcast();
+
 	return true;
 }
 
 bool UTextureStyleManager::UpdateClassColor(const FString& ClassName, const FColor& NewClassColor)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const uint16 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	FSemanticClass* SemanticClass = TextureMappingAsset->FindClass(ClassId);
+	if (SemanticClass == nullptr)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Requested semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
 		return false;
 	}
 
-	if (TextureMappingAsset->SemanticClasses[ClassName].Color == NewClassColor)
+	if (SemanticClass->Color == NewClassColor)
 	{
 		return true;
 	}
 
 	// Check if color is already in use
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (auto& Element : TextureMappingAsset->Classes())
 	{
-		const FSemanticClass& SemanticClass = Element.Value;
-		if (SemanticClass.Color == NewClassColor)
+		const FSemanticClass& OtherSemanticClass = Element.Value;
+		if (OtherSemanticClass.Color == NewClassColor)
 		{
 			UE_LOG(LogEasySynth, Warning, TEXT("%s: Requested color (%d %d %d) already used by %s"),
-				*FString(__FUNCTION__), NewClassColor.R, NewClassColor.G, NewClassColor.B, *SemanticClass.Name);
+				*FString(__FUNCTION__), NewClassColor.R, NewClassColor.G, NewClassColor.B, *OtherSemanticClass.Name);
 			return false;
 		}
 	}
 
 	// Update the class color
-	TextureMappingAsset->SemanticClasses[ClassName].Color = NewClassColor;
-	// Invalidate the material instance
-	TextureMappingAsset->SemanticClasses[ClassName].PlainColorMaterialInstance = nullptr;
+	SemanticClass->Color = NewClassColor;
+	// Invalidate the landscape material instance, other actors only need their primitive color updated
+	SemanticClass->PlainColorMaterialInstance = nullptr;
+	// Stencil values remain the same, only the color lookup changes
+	SemanticStencilManager->UpdateSemanticClasses(TextureMappingAsset->Classes());
 	// Update each actor color immediately in case of the semantic view mode
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	if (!bSemanticStencilMode)
 	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == ClassName)
+		for (AActor* Actor : FindPaintableActors(TextureMappingAsset->ClassActors(ClassId)))
 		{
-			SetSemanticClassToActor(Actor, ClassName);
+			SetSemanticClassToActor(Actor, ClassId);
 		}
 	}
 
@@ -208,7 +232,8 @@ bool UTextureStyleManager::UpdateClassColor(const FString& ClassName, const FCol
 
 bool UTextureStyleManager::RemoveSemanticClass(const FString& ClassName)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const uint16 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId == UTextureMappingAsset::InvalidClassId)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Requested semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
@@ -221,20 +246,18 @@ bool UTextureStyleManager::RemoveSemanticClass(const FString& ClassName)
 		return true;
 	}
 
-	// Reset all actor to the undefined class
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	// Reset all actor to the undefined class, copying the class actors as resetting modifies them
+	const TSet<FGuid> ClassActorGuids = TextureMappingAsset->ClassActors(ClassId);
+	for (AActor* Actor : FindPaintableActors(ClassActorGuids))
 	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == ClassName)
-		{
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName);
-		}
+		SetSemanticClassToActor(Actor, UndefinedClassId());
 	}
+	// Actors outside of the current level are only rebound
+	TextureMappingAsset->MoveClassActors(ClassId, UndefinedClassId());
 
 	// Remove the class
-	TextureMappingAsset->SemanticClasses.Remove(ClassName);
+	TextureMappingAsset->RemoveClass(ClassId);
+	SemanticStencilManager->UpdateSemanticClasses(TextureMappingAsset->Classes());
 
 	SaveTextureMappingAsset();
 
@@ -246,9 +269,9 @@ bool UTextureStyleManager::RemoveSemanticClass(const FString& ClassName)
 
 void UTextureStyleManager::RemoveAllSemanticCLasses()
 {
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	// Iterate over a copy of class names, as removing classes modifies the class map
+	for (const FString& ClassName : SemanticClassNames())
 	{
-		const FString& ClassName = Element.Key;
 		// Skip the default undefined semantic class
 		if (ClassName != UndefinedSemanticClassName)
 		{
@@ -257,12 +280,125 @@ void UTextureStyleManager::RemoveAllSemanticCLasses()
 	}
 }
 
+bool UTextureStyleManager::ImportSemanticClasses(const TArray<FSemanticClass>& ImportedClasses, FString& OutErrorMessage)
+{
+	// Validate all classes before anything is modified
+	TSet<FString> ClassNames;
+	TSet<FColor> ClassColors;
+	ClassNames.Reserve(ImportedClasses.Num());
+	ClassColors.Reserve(ImportedClasses.Num());
+	for (const FSemanticClass& ImportedClass : ImportedClasses)
+	{
+		if (ImportedClass.Name.Len() == 0)
+		{
+			OutErrorMessage = TEXT("Cannot import a class with the name ''");
+			return false;
+		}
+
+		bool bAlreadyImported = false;
+		ClassNames.Add(ImportedClass.Name, &bAlreadyImported);
+		if (bAlreadyImported)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Semantic class '%s' is imported more than once"), *ImportedClass.Name);
+			return false;
+		}
+
+		ClassColors.Add(ImportedClass.Color, &bAlreadyImported);
+		if (bAlreadyImported)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Color (%d %d %d) of the semantic class '%s' is already imported"),
+				ImportedClass.Color.R, ImportedClass.Color.G, ImportedClass.Color.B, *ImportedClass.Name);
+			return false;
+		}
+	}
+
+	// The undefined class is kept even if it is not imported, so its color has to remain unique
+	const bool bUndefinedClassImported = ClassNames.Contains(UndefinedSemanticClassName);
+	if (!bUndefinedClassImported && ClassColors.Contains(ClassColor(UndefinedSemanticClassName)))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Imported classes use the color of the '%s' semantic class"),
+			*UndefinedSemanticClassName);
+		return false;
+	}
+
+	const int ClassCount = ClassNames.Num() + (bUndefinedClassImported ? 0 : 1);
+	if (ClassCount > MAX_uint16)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Cannot import %d semantic classes, at most %d are supported"),
+			ClassCount, MAX_uint16);
+		return false;
+	}
+
+	// Remove classes that are not imported, copying class actors as resetting them modifies the class actors
+	const uint16 DefaultClassId = UndefinedClassId();
+	TArray<uint16> RemovedClassIds;
+	for (const TPair<uint16, FSemanticClass>& Element : TextureMappingAsset->Classes())
+	{
+		if (Element.Key != DefaultClassId && !ClassNames.Contains(Element.Value.Name))
+		{
+			RemovedClassIds.Add(Element.Key);
+		}
+	}
+	for (const uint16 ClassId : RemovedClassIds)
+	{
+		const TSet<FGuid> ClassActorGuids = TextureMappingAsset->ClassActors(ClassId);
+		for (AActor* Actor : FindPaintableActors(ClassActorGuids))
+		{
+			SetSemanticClassToActor(Actor, DefaultClassId);
+		}
+		// Actors outside of the current level are only rebound
+		TextureMappingAsset->MoveClassActors(ClassId, DefaultClassId);
+		TextureMappingAsset->RemoveClass(ClassId);
+	}
+
+	// Add new classes and update colors of the kept ones
+	TArray<uint16> RecoloredClassIds;
+	for (const FSemanticClass& ImportedClass : ImportedClasses)
+	{
+		FSemanticClass* SemanticClass = TextureMappingAsset->FindClass(TextureMappingAsset->FindClassId(ImportedClass.Name));
+		if (SemanticClass == nullptr)
+		{
+			TextureMappingAsset->AddClass(ImportedClass.Name, ImportedClass.Color);
+		}
+		else if (SemanticClass->Color != ImportedClass.Color)
+		{
+			SemanticClass->Color = ImportedClass.Color;
+			// Invalidate the landscape material instance
+			SemanticClass->PlainColorMaterialInstance = nullptr;
+			RecoloredClassIds.Add(SemanticClass->Id);
+		}
+	}
+	SemanticStencilManager->UpdateSemanticClasses(TextureMappingAsset->Classes());
+
+	// Update actor colors of kept classes, stencil values remain the same in the stencil mode
+	if (!bSemanticStencilMode)
+	{
+		for (const uint16 ClassId : RecoloredClassIds)
+		{
+			for (AActor* Actor : FindPaintableActors(TextureMappingAsset->ClassActors(ClassId)))
+			{
+				SetSemanticClassToActor(Actor, ClassId);
+			}
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Imported %d semantic classes, %d removed and %d recolored"),
+		*FString(__FUNCTION__), ImportedClasses.Num(), RemovedClassIds.Num(), RecoloredClassIds.Num())
+
+	SaveTextureMappingAsset();
+
+	// Broadcast the semantic classes change
+	SemanticClassesUpdatedEvent.Broadcast();
+
+	return true;
+}
+
 TArray<FString> UTextureStyleManager::SemanticClassNames() const
 {
 	TArray<FString> SemanticClassNames;
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (auto& Element : TextureMappingAsset->Classes())
 	{
-		SemanticClassNames.Add(Element.Key);
+		SemanticClassNames.Add(Element.Value.Name);
 	}
 	return SemanticClassNames;
 }
@@ -270,7 +406,7 @@ TArray<FString> UTextureStyleManager::SemanticClassNames() const
 TArray<const FSemanticClass*> UTextureStyleManager::SemanticClasses() const
 {
 	TArray<const FSemanticClass*> SemanticClasses;
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (auto& Element : TextureMappingAsset->Classes())
 	{
 		SemanticClasses.Add(&Element.Value);
 	}
@@ -279,7 +415,8 @@ TArray<const FSemanticClass*> UTextureStyleManager::SemanticClasses() const
 
 void UTextureStyleManager::ApplySemanticClassToSelectedActors(const FString& ClassName)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const uint16 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId == UTextureMappingAsset::InvalidClassId)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: Received semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
@@ -302,12 +439,55 @@ void UTextureStyleManager::ApplySemanticClassToSelectedActors(const FString& Cla
 		}
 
 		// Set the class to the actor
-		SetSemanticClassToActor(SelectedActor, ClassName);
+		SetSemanticClassToActor(SelectedActor, ClassId);
 	}
 
 	SaveTextureMappingAsset();
 }
 
+int UTextureStyleManager::ApplySemanticClassesToActors(const TMap<AActor*, FString>& ActorClassNames)
+{
+	// Class names are resolved once per class instead of once per actor
+	TMap<FString, uint16> ClassIds;
+	int UpdatedActorCount = 0;
+	for (const TPair<AActor*, FString>& Element : ActorClassNames)
+	{
+		AActor* Actor = Element.Key;
+		const FString& ClassName = Element.Value;
+
+		const uint16* CachedClassId = ClassIds.Find(ClassName);
+		if (CachedClassId == nullptr)
+		{
+			CachedClassId = &ClassIds.Add(ClassName, TextureMappingAsset->FindClassId(ClassName));
+			if (*CachedClassId == UTextureMappingAsset::InvalidClassId)
+			{
+				UE_LOG(LogEasySynth, Warning, TEXT("%s: Semantic class '%s' not found"),
+					*FString(__FUNCTION__), *ClassName)
+			}
+		}
+		const uint16 ClassId = *CachedClassId;
+		if (ClassId == UTextureMappingAsset::InvalidClassId)
+		{
+			continue;
+		}
+
+		if (TextureMappingAsset->FindActorClassId(Actor->GetActorGuid()) == ClassId)
+		{
+			continue;
+		}
+
+		SetSemanticClassToActor(Actor, ClassId);
+		UpdatedActorCount++;
+	}
+
+	if (UpdatedActorCount > 0)
+	{
+		SaveTextureMappingAsset();
+	}
+
+	return UpdatedActorCount;
+}
+
 void UTextureStyleManager::CheckoutTextureStyle(const ETextureStyle NewTextureStyle)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: New texture style: %d"), *FString(__FUNCTION__), NewTextureStyle)
@@ -319,26 +499,79 @@ void UTextureStyleManager::CheckoutTextureStyle(const ETextureStyle NewTextureSt
 		return;
 	}
 
-	// Apply materials to all actors
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	// In the stencil mode, a single post process material displays the classes painted into actor stencils
+	if (bSemanticStencilMode)
 	{
-		CheckoutActorTexture(Actor, NewTextureStyle);
+		SemanticStencilManager->SetEditorViewEnabled(NewTextureStyle == ETextureStyle::SEMANTIC);
 	}
 
-	// Make sure any changes to the TextureMappingAsset are changed
-	SaveTextureMappingAsset();
+	// Apply materials to all actors that have anything to paint, unless they already display the needed ones
+	const ETextureStyle NewMaterialTextureStyle = MaterialTextureStyle(NewTextureStyle);
+	if (NewMaterialTextureStyle != MaterialTextureStyle(CurrentTextureStyle))
+	{
+		for (AActor* Actor : AllPaintableActors())
+		{
+			CheckoutActorTexture(Actor, NewMaterialTextureStyle);
+		}
+
+		// Landscape materials are swapped together, instead of rebuilding the landscape once per proxy
+		TextureBackupManager->UpdatePendingLandscapes();
+
+		// Make sure any changes to the TextureMappingAsset are changed
+		SaveTextureMappingAsset();
+	}
 
 	CurrentTextureStyle = NewTextureStyle;
 }
 
+void UTextureStyleManager::SetSemanticStencilMode(const bool bEnabled)
+{
+	if (bEnabled == bSemanticStencilMode)
+	{
+		return;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Semantic stencil mode: %d"), *FString(__FUNCTION__), bEnabled)
+
+	// Leave the current mode with original materials displayed and display the same style using the new mode
+	const ETextureStyle DisplayedTextureStyle = CurrentTextureStyle;
+	CheckoutTextureStyle(ETextureStyle::COLOR);
+	bSemanticStencilMode = bEnabled;
+	if (bSemanticStencilMode)
+	{
+		// Stencils are painted once, later class changes repaint only the affected actors
+		SemanticStencilManager->EnableCustomDepthStencil();
+		PaintAllActorStencils();
+	}
+	else
+	{
+		// Primitives get back the custom depth settings they had before, e.g. those used by outline effects
+		SemanticStencilManager->RestoreOriginalStencils();
+	}
+	CheckoutTextureStyle(DisplayedTextureStyle);
+}
+
+UMaterial* UTextureStyleManager::SemanticStencilMaterial()
+{
+	return SemanticStencilManager->GetPostProcessMaterial();
+}
+
 bool UTextureStyleManager::ExportSemanticClasses(const FString& OutputDir)
 {
 	FSemanticCsvInterface SemanticCsvInterface;
 	return SemanticCsvInterface.ExportSemanticClasses(OutputDir, TextureMappingAsset);
 }
 
+bool UTextureStyleManager::ExportInstances(const FString& OutputDir)
+{
+	// IDs are assigned to all actors at once, so that they do not depend on the order actors are painted in,
+	// except for landscapes, which can not display their IDs and are rendered as background
+	TArray<AActor*> Actors = AllPaintableActors();
+	Actors.RemoveAll([](AActor* Actor) { return Cast<ALandscapeProxy>(Actor) != nullptr; });
+	InstanceIdManager->AssignInstanceIds(Actors);
+	return InstanceIdManager->ExportInstances(OutputDir, Actors, TextureMappingAsset);
+}
+
 void UTextureStyleManager::LoadOrCreateTextureMappingAsset()
 {
 	// Try to load
@@ -374,25 +607,71 @@ void UTextureStyleManager::LoadOrCreateTextureMappingAsset()
 void UTextureStyleManager::SaveTextureMappingAsset()
 {
 	check(TextureMappingAsset)
+	bTextureMappingAssetDirty = true;
+	SaveRequestCount++;
+
+	// Modifications made until the timer fires are saved together
+	if (!GEditor->GetTimerManager()->IsTimerActive(SaveTimerHandle))
+	{
+		const bool bLoop = false;
+		GEditor->GetTimerManager()->SetTimer(
+			SaveTimerHandle,
+			this,
+			&UTextureStyleManager::FlushTextureMappingAsset,
+			SaveIntervalSeconds,
+			bLoop);
+	}
+}
+
+void UTextureStyleManager::FlushTextureMappingAsset()
+{
+	GEditor->GetTimerManager()->ClearTimer(SaveTimerHandle);
+	if (!bTextureMappingAssetDirty)
+	{
+		return;
+	}
+
+	check(TextureMappingAsset)
+	const double StartSeconds = FPlatformTime::Seconds();
 	const bool bOnlyIfIsDirty = false;
 	UEditorAssetLibrary::SaveLoadedAsset(TextureMappingAsset, bOnlyIfIsDirty);
+	const double SaveSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	SaveCount++;
+	TotalSaveSeconds += SaveSeconds;
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Saved %d modifications in %.3f s (%d saves in %.3f s in total)"),
+		*FString(__FUNCTION__), SaveRequestCount, SaveSeconds, SaveCount, TotalSaveSeconds)
+
+	bTextureMappingAssetDirty = false;
+	SaveRequestCount = 0;
 }
 
 void UTextureStyleManager::OnLevelActorAdded(AActor* Actor)
 {
+	// Ignore transient actors, such as the stencil mode post process volume, as they are not saved with the level
+	if (Actor->HasAnyFlags(RF_Transient))
+	{
+		return;
+	}
+
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Adding actor '%s'"), *FString(__FUNCTION__), *Actor->GetName())
 
 	// Preemptively assign the undefined semantic class to the new actor
 	// In the case of the semantic mode being selected, assigned class will be immediately displayed
 	const bool bForceDisplaySemanticClass = false;
 	const bool bDelayAddingDescriptors = true;
-	SetSemanticClassToActor(Actor, UndefinedSemanticClassName, bForceDisplaySemanticClass, bDelayAddingDescriptors);
+	SetSemanticClassToActor(
+		Actor,
+		UndefinedClassId(),
+		bForceDisplaySemanticClass,
+		bDelayAddingDescriptors);
 }
 
 void UTextureStyleManager::OnLevelActorDeleted(AActor* Actor)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Removing actor '%s'"), *FString(__FUNCTION__), *Actor->GetName())
-	TextureMappingAsset->ActorClassPairs.Remove(Actor->GetActorGuid());
+	TextureMappingAsset->RemoveActor(Actor->GetActorGuid());
+	PaintableActors.Remove(Actor->GetActorGuid());
 	TextureBackupManager->RemoveActor(Actor);
 }
 
@@ -400,23 +679,53 @@ void UTextureStyleManager::OnEditorClose()
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Making sure original mesh colors are selected"), *FString(__FUNCTION__))
 	CheckoutTextureStyle(ETextureStyle::COLOR);
+	// Painted stencils must not be saved with the level
+	SemanticStencilManager->RestoreOriginalStencils();
+	// Save pending texture mapping asset modifications
+	FlushTextureMappingAsset();
 	// Make level dirty and save it
 	ULevel* Level = GWorld->GetCurrentLevel();
 	Level->MarkPackageDirty();
 	FEditorFileUtils::SaveLevel(Level);
 }
 
+void UTextureStyleManager::OnPreSaveWorld(UWorld* World, FObjectPreSaveContext ObjectSaveContext)
+{
+	// Painted stencils must not be saved with the level, so they are painted again once it is saved
+	if (bSemanticStencilMode)
+	{
+		SemanticStencilManager->RestoreOriginalStencils();
+	}
+}
+
+void UTextureStyleManager::OnPostSaveWorld(UWorld* World, FObjectPostSaveContext ObjectSaveContext)
+{
+	if (bSemanticStencilMode)
+	{
+		SemanticStencilManager->EnableCustomDepthStencil();
+		PaintAllActorStencils();
+	}
+}
+
 void UTextureStyleManager::SetSemanticClassToActor(
 	AActor* Actor,
-	const FString& ClassName,
+	const uint16 ClassId,
 	const bool bForceDisplaySemanticClass,
 	const bool bDelayAddingDescriptors)
 {
-	// Remove class if already assigned
-	TextureMappingAsset->ActorClassPairs.Remove(Actor->GetActorGuid());
+	// Set the new class, replacing the already assigned one
+	TextureMappingAsset->SetActorClass(Actor->GetActorGuid(), ClassId);
+	if (IsPaintableActor(Actor))
+	{
+		PaintableActors.Add(Actor->GetActorGuid(), Actor);
+	}
 
-	// Set the new class
-	TextureMappingAsset->ActorClassPairs.Add(Actor->GetActorGuid(), ClassName);
+	// In the stencil mode, the painted stencil value is all that is needed to display the class
+	if (bSemanticStencilMode)
+	{
+		SemanticStencilManager->PaintActor(Actor, ClassId);
+		return;
+	}
 
 	// Immediately display the change when in the semantic mode
 	if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
@@ -449,49 +758,203 @@ void UTextureStyleManager::SetSemanticClassToActor(
 
 void UTextureStyleManager::CheckoutActorTexture(AActor* Actor, const ETextureStyle NewTextureStyle)
 {
-	// Check if the actor has a semantic class assigned
-	const FGuid& ActorGuid = Actor->GetActorGuid();
-	if (!TextureMappingAsset->ActorClassPairs.Contains(ActorGuid))
+	// Check whether the actor currently has its original materials active
+	// It it does, the original materials will be backed up
+	const bool bOriginalTextureActive = !TextureBackupManager->ContainsActor(Actor);
+
+	// If the actor has original texture and is changing to the same one, ignore the actor
+	if (bOriginalTextureActive && NewTextureStyle == ETextureStyle::COLOR)
+	{
+		return;
+	}
+
+	// Semantic and instance colors are written into actor primitives and displayed by the shared material
+	UMaterialInstanceConstant* Material = nullptr;
+	TOptional<FColor> PrimitiveColor;
+	if (NewTextureStyle == ETextureStyle::SEMANTIC)
 	{
-		if (NewTextureStyle == ETextureStyle::SEMANTIC)
+		// Check if the actor has a semantic class assigned
+		const uint16 ClassId = TextureMappingAsset->FindActorClassId(Actor->GetActorGuid());
+		if (ClassId == UTextureMappingAsset::InvalidClassId)
 		{
 			// If semantic view is being selected, assign the default class to the actor
 			// This method will be recalled by the following method
 			const bool bForceDisplaySemanticClass = true;
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName, bForceDisplaySemanticClass);
+			SetSemanticClassToActor(Actor, UndefinedClassId(), bForceDisplaySemanticClass);
+			return;
+		}
+
+		// Make sure the semantic class ID is valid
+		FSemanticClass* SemanticClass = TextureMappingAsset->FindClass(ClassId);
+		if (SemanticClass == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Uknown class ID %d"), *FString(__FUNCTION__), ClassId)
+			return;
+		}
+
+		if (Cast<ALandscapeProxy>(Actor) != nullptr)
+		{
+			Material = GetLandscapeClassMaterial(*SemanticClass);
 		}
+		else
+		{
+			Material = GetPrimitiveColorMaterial();
+			PrimitiveColor = SemanticClass->Color;
+		}
+	}
+	else if (NewTextureStyle == ETextureStyle::INSTANCE)
+	{
+		Material = GetPrimitiveColorMaterial();
+		if (Cast<ALandscapeProxy>(Actor) == nullptr)
+		{
+			PrimitiveColor = InstanceIdManager->ActorColor(Actor);
+		}
+	}
+
+	if (NewTextureStyle != ETextureStyle::COLOR && Material == nullptr)
+	{
 		return;
 	}
 
-	// Get the name of the semantic class assigned to the actor
-	const FString& ClassName = TextureMappingAsset->ActorClassPairs[ActorGuid];
+	// Update the actor texture, unless the actor already displays the same material
+	if (Material == nullptr || bOriginalTextureActive || TextureBackupManager->PaintedMaterial(Actor) != Material)
+	{
+		const bool bDoAdd = bOriginalTextureActive;
+		const bool bDoPaint = true;
+		TextureBackupManager->AddAndPaint(Actor, bDoAdd, bDoPaint, Material);
+	}
 
-	// Make sure the semantic class name is valid
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	// Changing the color is only a data update, the shared material stays the same
+	if (PrimitiveColor.IsSet())
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Uknown class name '%s'"), *FString(__FUNCTION__), *ClassName)
-		return;
+		TextureBackupManager->PaintPrimitiveColor(Actor, PrimitiveColor.GetValue());
 	}
+}
 
-	// Check whether the actor currently has its original materials active
-	// It it does, the original materials will be backed up
-	const bool bOriginalTextureActive = !TextureBackupManager->ContainsActor(Actor);
+ETextureStyle UTextureStyleManager::MaterialTextureStyle(const ETextureStyle TextureStyle) const
+{
+	// The stencil mode displays semantic classes over original materials
+	if (bSemanticStencilMode && TextureStyle == ETextureStyle::SEMANTIC)
+	{
+		return ETextureStyle::COLOR;
+	}
+	return TextureStyle;
+}
 
-	// If the actor has original texture and is changing to the same one, ignore the actor
-	if (bOriginalTextureActive && NewTextureStyle == ETextureStyle::COLOR)
+void UTextureStyleManager::PaintAllActorStencils()
+{
+	const uint16 DefaultClassId = UndefinedClassId();
+	for (AActor* Actor : AllPaintableActors())
 	{
-		return;
+		const uint16 ClassId = TextureMappingAsset->FindActorClassId(Actor->GetActorGuid());
+		if (ClassId != UTextureMappingAsset::InvalidClassId)
+		{
+			SemanticStencilManager->PaintActor(Actor, ClassId);
+		}
+		else
+		{
+			SetSemanticClassToActor(Actor, DefaultClassId);
+		}
 	}
 
-	// Update the actor texture
-	const bool bDoAdd = bOriginalTextureActive;
-	const bool bDoPaint = true;
-	UMaterialInstanceConstant* Material = nullptr;
-	if (NewTextureStyle == ETextureStyle::SEMANTIC)
+	SaveTextureMappingAsset();
+}
+
+uint16 UTextureStyleManager::UndefinedClassId() const
+{
+	return TextureMappingAsset->FindClassId(UndefinedSemanticClassName);
+}
+
+TArray<AActor*> UTextureStyleManager::FindPaintableActors(const TSet<FGuid>& ActorGuids)
+{
+	UpdatePaintableActorsWorld();
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(ActorGuids.Num());
+	for (const FGuid& ActorGuid : ActorGuids)
+	{
+		// Actors not found in the registry belong to other levels or have nothing to paint
+		const TWeakObjectPtr<AActor>* RegisteredActor = PaintableActors.Find(ActorGuid);
+		if (RegisteredActor == nullptr)
+		{
+			continue;
+		}
+
+		// Actors can be destroyed without being deleted by the user, e.g. by undoing their creation
+		if (!RegisteredActor->IsValid())
+		{
+			RebuildPaintableActors();
+			return FindPaintableActors(ActorGuids);
+		}
+		Actors.Add(RegisteredActor->Get());
+	}
+	return Actors;
+}
+
+TArray<AActor*> UTextureStyleManager::AllPaintableActors()
+{
+	UpdatePaintableActorsWorld();
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(PaintableActors.Num());
+	for (const TPair<FGuid, TWeakObjectPtr<AActor>>& Element : PaintableActors)
+	{
+		if (!Element.Value.IsValid())
+		{
+			RebuildPaintableActors();
+			return AllPaintableActors();
+		}
+		Actors.Add(Element.Value.Get());
+	}
+	return Actors;
+}
+
+void UTextureStyleManager::UpdatePaintableActorsWorld()
+{
+	// Actors of a different world are not valid anymore
+	if (PaintableActorsWorld != GEditor->GetEditorWorldContext().World())
+	{
+		RebuildPaintableActors();
+	}
+}
+
+void UTextureStyleManager::RebuildPaintableActors()
+{
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	TArray<AActor*> LevelActors;
+	UGameplayStatics::GetAllActorsOfClass(World, AActor::StaticClass(), LevelActors);
+
+	PaintableActors.Reset();
+	for (AActor* Actor : LevelActors)
+	{
+		if (IsPaintableActor(Actor))
+		{
+			PaintableActors.Add(Actor->GetActorGuid(), Actor);
+		}
+	}
+	PaintableActorsWorld = World;
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Found %d paintable out of %d level actors"),
+		*FString(__FUNCTION__), PaintableActors.Num(), LevelActors.Num())
+}
+
+bool UTextureStyleManager::IsPaintableActor(AActor* Actor)
+{
+	// Transient actors, such as the stencil mode post process volume, are not saved with the level
+	if (Actor->HasAnyFlags(RF_Transient))
+	{
+		return false;
+	}
+
+	if (Cast<ALandscapeProxy>(Actor) != nullptr)
 	{
-		Material = GetSemanticClassMaterial(TextureMappingAsset->SemanticClasses[ClassName]);
+		return true;
 	}
-	TextureBackupManager->AddAndPaint(Actor, bDoAdd, bDoPaint, Material);
+
+	TArray<UPrimitiveComponent*> PrimitiveComponents;
+	const bool bIncludeFromChildActors = true;
+	Actor->GetComponents(PrimitiveComponents, bIncludeFromChildActors);
+	return PrimitiveComponents.Num() > 0;
 }
 
 void UTextureStyleManager::ProcessDelayActorBuffer()
@@ -502,7 +965,7 @@ void UTextureStyleManager::ProcessDelayActorBuffer()
 		if (IsValid(Actor))
 		{
 			// Must not call with bDelayAddingDescriptors = true, to avoid infinite recursion
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName);
+			SetSemanticClassToActor(Actor, UndefinedClassId());
 			bAnyActorProcessed = true;
 		}
 	}
@@ -513,36 +976,56 @@ void UTextureStyleManager::ProcessDelayActorBuffer()
 	}
 }
 
-UMaterialInstanceConstant* UTextureStyleManager::GetSemanticClassMaterial(FSemanticClass& SemanticClass)
+UMaterialInstanceConstant* UTextureStyleManager::GetLandscapeClassMaterial(FSemanticClass& SemanticClass)
 {
 	// If the plain color material is null, create it
 	if (SemanticClass.PlainColorMaterialInstance == nullptr)
 	{
-		UMaterialInstanceConstantFactoryNew* Factory = NewObject<UMaterialInstanceConstantFactoryNew>();
-		Factory->InitialParent = PlainColorMaterial;
-
-		const FString PackageFileName = FString::Printf(TEXT("M_%s"), *(SemanticClass.Name));
-		const FString PackagePath =
-			FPathUtils::ProjectPluginContentDir() / FString(TEXT("ConstMaterials")) / PackageFileName;
-		UPackage* Package = CreatePackage(*PackagePath);
-		SemanticClass.PlainColorMaterialInstance = Cast<UMaterialInstanceConstant>(Factory->FactoryCreateNew(
-			UMaterialInstanceConstant::StaticClass(),
-			Package,
-			*PackageFileName,
-			RF_Public | RF_Transient,
-			NULL,
-			GWarn));
-
-		if (SemanticClass.PlainColorMaterialInstance == nullptr)
-		{
-			UE_LOG(LogTemp, Error, TEXT("%s: Could not create the plain color material instance"),
-				*FString(__FUNCTION__))
-			check(SemanticClass.PlainColorMaterialInstance)
-		}
+		// The instance only lives while the editor is running, so no package is needed
+		SemanticClass.PlainColorMaterialInstance = NewObject<UMaterialInstanceConstant>(this, NAME_None, RF_Transient);
+		SemanticClass.PlainColorMaterialInstance->SetParentEditorOnly(PlainColorMaterial);
 		SemanticClass.PlainColorMaterialInstance->SetVectorParameterValueEditorOnly(
 			*SemanticColorParameter,
 			SemanticClass.Color);
+		SemanticClass.PlainColorMaterialInstance->PostEditChange();
 	}
 
 	return SemanticClass.PlainColorMaterialInstance;
 }
+
+UMaterialInstanceConstant* UTextureStyleManager::GetPrimitiveColorMaterial()
+{
+	if (PrimitiveColorMaterial == nullptr)
+	{
+		// Make the plain color material read its color parameter from the custom primitive data
+		UMaterial* Material = DuplicateObject<UMaterial>(PlainColorMaterial, this);
+		bool bParameterFound = false;
+		for (UMaterialExpression* Expression : Material->GetExpressions())
+		{
+			UMaterialExpressionVectorParameter* Parameter = Cast<UMaterialExpressionVectorParameter>(Expression);
+			if (Parameter != nullptr && Parameter->ParameterName == *SemanticColorParameter)
+			{
+				Parameter->bUseCustomPrimitiveData = true;
+				Parameter->PrimitiveDataIndex = 0;
+				// Primitives without custom primitive data display black
+				Parameter->DefaultValue = FLinearColor::Black;
+				bParameterFound = true;
+			}
+		}
+		if (!bParameterFound)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Plain color material parameter '%s' not found"),
+				*FString(__FUNCTION__), *SemanticColorParameter)
+			return nullptr;
+		}
+		UMaterialEditingLibrary::RecompileMaterial(Material);
+
+		// Actors are painted with material instances, same as landscapes with semantic class materials
+		PrimitiveColorMaterial = NewObject<UMaterialInstanceConstant>(
+			this, TEXT("MI_PrimitiveColor"), RF_Transient);
+		PrimitiveColorMaterial->SetParentEditorOnly(Material);
+		PrimitiveColorMaterial->PostEditChange();
+	}
+
+	return PrimitiveColorMaterial;
+}
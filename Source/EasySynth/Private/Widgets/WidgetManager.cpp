@@ -77,6 +77,7 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 	TargetCheckBoxNames.Add(FRendererTargetOptions::NORMAL_IMAGE, LOCTEXT("NormalImagesCheckBoxText", "Normal images"));
 	TargetCheckBoxNames.Add(FRendererTargetOptions::OPTICAL_FLOW_IMAGE, LOCTEXT("OpticalFlowImagesCheckBoxText", "Optical flow images"));
 	TargetCheckBoxNames.Add(FRendererTargetOptions::SEMANTIC_IMAGE, LOCTEXT("SemanticImagesCheckBoxText", "Semantic images"));
+	TargetCheckBoxNames.Add(FRendererTargetOptions::INSTANCE_IMAGE, LOCTEXT("InstanceImagesCheckBoxText", "Instance images"));
 	for (auto Element : TargetCheckBoxNames)
 	{
 		const FRendererTargetOptions::TargetType TargetType = Element.Key;
@@ -109,6 +110,17 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 						.Text_Raw(this, &FWidgetManager::SelectedOutputFormat, TargetType)
 					]
 				]
+				+SHorizontalBox::Slot()
+				[
+					SNew(SSpinBox<float>)
+					.ToolTipText(LOCTEXT("ResolutionScaleToolTipText", "Output image resolution scale of the target"))
+					.Value_Lambda([this, TargetType](){ return SequenceRendererTargets.ResolutionScale(TargetType); })
+					.OnValueChanged_Lambda(
+						[this, TargetType](const float NewValue)
+						{ SequenceRendererTargets.SetResolutionScale(TargetType, NewValue); })
+					.MinValue(0.1f)
+					.MaxValue(4.0f)
+				]
 			];
 	}
 
@@ -134,6 +146,20 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 			]
 			+SScrollBox::Slot()
 			.Padding(2)
+			[
+				SNew(SButton)
+				.OnClicked_Raw(
+					&SemanticRuleEngine,
+					&FSemanticRuleEngine::OnApplySemanticRulesClicked,
+					TextureStyleManager)
+				.Content()
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ApplySemanticRulesButtonText", "Apply semantic rules JSON file"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
 			[
 				SNew(SButton)
 				.OnClicked_Raw(&CameraRigRosInterface, &FCameraRigRosInterface::OnImportCameraRigClicked)
@@ -193,6 +219,28 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 			]
 			+SScrollBox::Slot()
 			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.SemanticStencilMode();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{
+						const bool bChecked = NewState == ECheckBoxState::Checked;
+						SequenceRendererTargets.SetSemanticStencilMode(bChecked);
+						TextureStyleManager->SetSemanticStencilMode(bChecked);
+					})
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("SemanticStencilModeCheckBoxText", "Display semantic classes using custom depth stencil"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
 			[
 				SNew(STextBlock)
 				.Text(LOCTEXT("PickSequencerSectionTitle", "Pick sequencer"))
@@ -238,6 +286,78 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 			]
 			+SScrollBox::Slot()
 			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.SinglePassRendering();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetSinglePassRendering(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("SinglePassRenderingCheckBoxText", "Render compatible targets in a single pass"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.TargetMajorOrder();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetTargetMajorOrder(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("TargetMajorOrderCheckBoxText", "Render each target with all cameras before the next one"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.RenderAllRigCameras();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetRenderAllRigCameras(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("RenderAllRigCamerasCheckBoxText", "Render all rig cameras in a single pass"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.ResumeRendering();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetResumeRendering(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ResumeRenderingCheckBoxText", "Resume the previous rendering into the output directory"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
 			[
 				SNew(STextBlock)
 				.Text(LOCTEXT("OutputWidthText", "Output image width [px]"))
@@ -312,6 +432,70 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 			]
 			+SScrollBox::Slot()
 			.Padding(2)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("FrameStrideText", "Render every N-th frame"))
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SSpinBox<int32>)
+				.Value_Lambda([this](){ return SequenceRendererTargets.FrameStride(); })
+				.OnValueChanged_Lambda(
+					[this](const int32 NewValue){ SequenceRendererTargets.SetFrameStride(NewValue); })
+				.MinValue(1)
+				.MaxValue(1000)
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("MinFrameTranslationText", "Camera movement needed to render a frame [cm]"))
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SSpinBox<float>)
+				.Value_Lambda([this](){ return SequenceRendererTargets.MinFrameTranslation(); })
+				.OnValueChanged_Lambda(
+					[this](const float NewValue){ SequenceRendererTargets.SetMinFrameTranslation(NewValue); })
+				.MinValue(0.0f)
+				.MaxValue(10000.0f)
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("MinFrameRotationText", "Camera rotation needed to render a frame [deg]"))
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SSpinBox<float>)
+				.Value_Lambda([this](){ return SequenceRendererTargets.MinFrameRotation(); })
+				.OnValueChanged_Lambda(
+					[this](const float NewValue){ SequenceRendererTargets.SetMinFrameRotation(NewValue); })
+				.MinValue(0.0f)
+				.MaxValue(180.0f)
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("MaxReadinessWaitText", "Longest wait for shaders and textures before each target [s]"))
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SSpinBox<float>)
+				.Value_Lambda([this](){ return SequenceRendererTargets.MaxReadinessWaitSeconds(); })
+				.OnValueChanged_Lambda(
+					[this](const float NewValue){ SequenceRendererTargets.SetMaxReadinessWaitSeconds(NewValue); })
+				.MinValue(0.0f)
+				.MaxValue(600.0f)
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
 			[
 				SNew(STextBlock)
 				.Text(LOCTEXT("OuputDirectoryText", "Ouput directory"))
@@ -534,6 +718,7 @@ void FWidgetManager::LoadWidgetOptionStates()
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::NORMAL_IMAGE, WidgetStateAsset->bNormalImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::OPTICAL_FLOW_IMAGE, WidgetStateAsset->bOpticalFlowImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::SEMANTIC_IMAGE, WidgetStateAsset->bSemanticImagesSelected);
+		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::INSTANCE_IMAGE, WidgetStateAsset->bInstanceImagesSelected);
 		SequenceRendererTargets.SetOutputFormat(
 			FRendererTargetOptions::COLOR_IMAGE,
 			static_cast<EImageFormat>(WidgetStateAsset->bColorImagesOutputFormat));
@@ -549,9 +734,34 @@ void FWidgetManager::LoadWidgetOptionStates()
 		SequenceRendererTargets.SetOutputFormat(
 			FRendererTargetOptions::SEMANTIC_IMAGE,
 			static_cast<EImageFormat>(WidgetStateAsset->bSemanticImagesOutputFormat));
+		SequenceRendererTargets.SetOutputFormat(
+			FRendererTargetOptions::INSTANCE_IMAGE,
+			static_cast<EImageFormat>(WidgetStateAsset->bInstanceImagesOutputFormat));
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::COLOR_IMAGE, WidgetStateAsset->ColorImagesResolutionScale);
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::DEPTH_IMAGE, WidgetStateAsset->DepthImagesResolutionScale);
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::NORMAL_IMAGE, WidgetStateAsset->NormalImagesResolutionScale);
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::OPTICAL_FLOW_IMAGE, WidgetStateAsset->OpticalFlowImagesResolutionScale);
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::SEMANTIC_IMAGE, WidgetStateAsset->SemanticImagesResolutionScale);
+		SequenceRendererTargets.SetResolutionScale(
+			FRendererTargetOptions::INSTANCE_IMAGE, WidgetStateAsset->InstanceImagesResolutionScale);
 		OutputImageResolution = WidgetStateAsset->OutputImageResolution;
 		SequenceRendererTargets.SetDepthRangeMeters(WidgetStateAsset->DepthRange);
 		SequenceRendererTargets.SetOpticalFlowScale(WidgetStateAsset->OpticalFlowScale);
+		SequenceRendererTargets.SetSinglePassRendering(WidgetStateAsset->bSinglePassRenderingSelected);
+		SequenceRendererTargets.SetTargetMajorOrder(WidgetStateAsset->bTargetMajorOrderSelected);
+		SequenceRendererTargets.SetRenderAllRigCameras(WidgetStateAsset->bRenderAllRigCamerasSelected);
+		SequenceRendererTargets.SetResumeRendering(WidgetStateAsset->bResumeRenderingSelected);
+		SequenceRendererTargets.SetSemanticStencilMode(WidgetStateAsset->bSemanticStencilModeSelected);
+		TextureStyleManager->SetSemanticStencilMode(WidgetStateAsset->bSemanticStencilModeSelected);
+		SequenceRendererTargets.SetFrameStride(WidgetStateAsset->FrameStride);
+		SequenceRendererTargets.SetMinFrameTranslation(WidgetStateAsset->MinFrameTranslation);
+		SequenceRendererTargets.SetMinFrameRotation(WidgetStateAsset->MinFrameRotation);
+		SequenceRendererTargets.SetMaxReadinessWaitSeconds(WidgetStateAsset->MaxReadinessWaitSeconds);
 		OutputDirectory = WidgetStateAsset->OutputDirectory;
 	}
 }
@@ -589,6 +799,7 @@ void FWidgetManager::SaveWidgetOptionStates()
 	WidgetStateAsset->bNormalImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::NORMAL_IMAGE);
 	WidgetStateAsset->bOpticalFlowImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::OPTICAL_FLOW_IMAGE);
 	WidgetStateAsset->bSemanticImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::SEMANTIC_IMAGE);
+	WidgetStateAsset->bInstanceImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::INSTANCE_IMAGE);
 	WidgetStateAsset->bColorImagesOutputFormat = static_cast<int8>(
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::COLOR_IMAGE));
 	WidgetStateAsset->bDepthImagesOutputFormat = static_cast<int8>(
@@ -599,9 +810,32 @@ void FWidgetManager::SaveWidgetOptionStates()
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::OPTICAL_FLOW_IMAGE));
 	WidgetStateAsset->bSemanticImagesOutputFormat = static_cast<int8>(
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::SEMANTIC_IMAGE));
+	WidgetStateAsset->bInstanceImagesOutputFormat = static_cast<int8>(
+		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::INSTANCE_IMAGE));
+	WidgetStateAsset->ColorImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::COLOR_IMAGE);
+	WidgetStateAsset->DepthImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::DEPTH_IMAGE);
+	WidgetStateAsset->NormalImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::NORMAL_IMAGE);
+	WidgetStateAsset->OpticalFlowImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::OPTICAL_FLOW_IMAGE);
+	WidgetStateAsset->SemanticImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::SEMANTIC_IMAGE);
+	WidgetStateAsset->InstanceImagesResolutionScale =
+		SequenceRendererTargets.ResolutionScale(FRendererTargetOptions::INSTANCE_IMAGE);
 	WidgetStateAsset->OutputImageResolution = OutputImageResolution;
 	WidgetStateAsset->DepthRange = SequenceRendererTargets.DepthRangeMeters();
 	WidgetStateAsset->OpticalFlowScale = SequenceRendererTargets.OpticalFlowScale();
+	WidgetStateAsset->bSinglePassRenderingSelected = SequenceRendererTargets.SinglePassRendering();
+	WidgetStateAsset->bTargetMajorOrderSelected = SequenceRendererTargets.TargetMajorOrder();
+	WidgetStateAsset->bRenderAllRigCamerasSelected = SequenceRendererTargets.RenderAllRigCameras();
+	WidgetStateAsset->bResumeRenderingSelected = SequenceRendererTargets.ResumeRendering();
+	WidgetStateAsset->bSemanticStencilModeSelected = SequenceRendererTargets.SemanticStencilMode();
+	WidgetStateAsset->FrameStride = SequenceRendererTargets.FrameStride();
+	WidgetStateAsset->MinFrameTranslation = SequenceRendererTargets.MinFrameTranslation();
+	WidgetStateAsset->MinFrameRotation = SequenceRendererTargets.MinFrameRotation();
+	WidgetStateAsset->MaxReadinessWaitSeconds = SequenceRendererTargets.MaxReadinessWaitSeconds();
 	WidgetStateAsset->OutputDirectory = OutputDirectory;
 
 	// Save the asset
@@ -1,3 +1,10 @@
 // Copyright (c) 2022 YDrive Inc. All rights reserved.
 
 #include "Widgets/WidgetStateAsset.h"
+
+#include "SequenceRenderer.h"
+
+
+UWidgetStateAsset::UWidgetStateAsset() :
+	MaxReadinessWaitSeconds(FRendererTargetOptions::DefaultMaxReadinessWaitSecondsValue)
+{}
@@ -65,11 +65,15 @@ public:
 	/** Imports camera rig from a ROS JSON file */
 	FReply OnImportCameraRigClicked();
 
-	/** Exports camera rig into a ROS JSON file */
+	/**
+	 * Exports camera rig into a ROS JSON file,
+	 * a separate file is saved for a target whose images differ in size from the other ones
+	*/
 	bool ExportCameraRig(
 		const FString& OutputDir,
 		TArray<UCameraComponent*> RigCameras,
-		const FIntPoint& SensorSize);
+		const FIntPoint& SensorSize,
+		const FString& TargetName = "");
 
 private:
 	/** Adds lines describing a single camera to the output array */
@@ -0,0 +1,32 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "EasySynthRenderCommandlet.generated.h"
+
+
+/**
+ * Commandlet that renders a level sequence without the editor UI,
+ * using options provided by a JSON job file
+ * Usage: UnrealEditor-Cmd <project> -run=EasySynthRender -job=<job.json> -AllowCommandletRendering
+ * Outputs of jobs that render separate shards of a sequence are merged with
+ * UnrealEditor-Cmd <project> -run=EasySynthRender -merge=<output directory>
+*/
+UCLASS()
+class UEasySynthRenderCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEasySynthRenderCommandlet();
+
+	/** Runs the rendering described by the job file, or merges shard outputs */
+	int32 Main(const FString& Params) override;
+
+private:
+	/** Merges outputs of sharded jobs inside the directory */
+	static int32 MergeShards(const FString& OutputDirectory);
+};
@@ -110,12 +110,25 @@ public:
 		return Directory / CameraRigFileName;
 	}
 
+	/** Full path to the camera rig ROS JSON file describing images of a specific target */
+	static FString TargetCameraRigFilePath(const FString& Directory, const FString& TargetName)
+	{
+		return Directory / FString::Printf(
+			TEXT("%s_%s.json"), *FPaths::GetBaseFilename(CameraRigFileName), *TargetName);
+	}
+
 	/** Full path to the semantic classes CSV file */
 	static FString SemanticClassesFilePath(const FString& Directory)
 	{
 		return Directory / SemanticClassesFileName;
 	}
 
+	/** Full path to the instances CSV file */
+	static FString InstancesFilePath(const FString& Directory)
+	{
+		return Directory / InstancesFileName;
+	}
+
 	/** Gets original camera name from the received camera component */
 	static FString GetCameraName(UCameraComponent* CameraComponent)
 	{
@@ -141,6 +154,32 @@ public:
 		return Directory / CameraPosesFileName;
 	}
 
+	/** Clean name of the camera poses file that covers only a part of the sequence frames */
+	static FString PartialCameraPosesFileName(const int StartFrame, const int EndFrame)
+	{
+		return FString::Printf(
+			TEXT("%s_%06d-%06d.csv"), *FPaths::GetBaseFilename(CameraPosesFileName), StartFrame, EndFrame);
+	}
+
+	/** Wildcard matching all partial camera poses files */
+	static FString PartialCameraPosesFileWildcard()
+	{
+		return FPaths::GetBaseFilename(CameraPosesFileName) + TEXT("_*.csv");
+	}
+
+	/** Full path to the render manifest file, separate for each rendered part of the sequence frames */
+	static FString RenderManifestFilePath(const FString& Directory, const int StartFrame, const int EndFrame)
+	{
+		return Directory / FString::Printf(
+			TEXT("%s_%06d-%06d.csv"), *FPaths::GetBaseFilename(RenderManifestFileName), StartFrame, EndFrame);
+	}
+
+	/** Wildcard matching render manifest files of all rendered parts of the sequence frames */
+	static FString RenderManifestFileWildcard()
+	{
+		return FPaths::GetBaseFilename(RenderManifestFileName) + TEXT("_*.csv");
+	}
+
 	/** Clean name of the rendering output directory */
 	static const FString RenderingOutputDirName;
 
@@ -150,6 +189,12 @@ public:
 	/** Clean name of the semantic classes CSV output file */
 	static const FString SemanticClassesFileName;
 
+	/** Clean name of the instances CSV output file */
+	static const FString InstancesFileName;
+
 	/** Clean name of the camera poses output file */
 	static const FString CameraPosesFileName;
+
+	/** Clean name of the render manifest output file */
+	static const FString RenderManifestFileName;
 };
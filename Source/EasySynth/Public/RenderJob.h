@@ -0,0 +1,149 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SequenceRenderer.h"
+
+#include "RenderJob.generated.h"
+
+
+/** Single renderer target requested by the render job */
+USTRUCT()
+struct FEasySynthRenderJobTarget
+{
+	GENERATED_BODY()
+
+	/** Name of the target, e.g. ColorImage or DepthImage */
+	UPROPERTY()
+	FString Name;
+
+	/** Output format of the target, jpeg, png or exr */
+	UPROPERTY()
+	FString Format = TEXT("jpeg");
+
+	/** Factor the output image resolution is multiplied by for this target */
+	UPROPERTY()
+	float ResolutionScale = 1.0f;
+
+	/** Compression of exr images, e.g. PIZ, ZIPS or DWAB, the renderer config decides if empty */
+	UPROPERTY()
+	FString Compression;
+
+	/** Compression level of exr images compressed with DWAA or DWAB */
+	UPROPERTY()
+	float CompressionLevel = 45.0f;
+};
+
+
+/**
+ * Description of a headless rendering, loaded from a JSON job file,
+ * that carries the same options the EasySynth widget provides
+*/
+USTRUCT()
+struct FEasySynthRenderJob
+{
+	GENERATED_BODY()
+
+	/** Map to be loaded before the rendering, the currently loaded one is used if empty */
+	UPROPERTY()
+	FString Map;
+
+	/** Level sequence asset to be rendered */
+	UPROPERTY()
+	FString Sequence;
+
+	/** Requested renderer targets */
+	UPROPERTY()
+	TArray<FEasySynthRenderJobTarget> Targets;
+
+	/** Whether to export camera poses */
+	UPROPERTY()
+	bool bExportCameraPoses = false;
+
+	/** Whether compatible targets are rendered as passes of a single job */
+	UPROPERTY()
+	bool bSinglePassRendering = false;
+
+	/** Whether each target is rendered with all rig cameras before the next target */
+	UPROPERTY()
+	bool bTargetMajorOrder = false;
+
+	/** Whether all rig cameras are rendered by a single job */
+	UPROPERTY()
+	bool bRenderAllRigCameras = false;
+
+	/** Whether the previous rendering into the output directory is resumed */
+	UPROPERTY()
+	bool bResume = false;
+
+	/** Whether semantic classes are rendered using custom depth stencil values instead of swapped materials */
+	UPROPERTY()
+	bool bSemanticStencilMode = false;
+
+	/** Semantic classes CSV file imported before semantic rules are applied, classes are kept if empty */
+	UPROPERTY()
+	FString SemanticClasses;
+
+	/** Semantic rules JSON file applied to level actors before the rendering, none is applied if empty */
+	UPROPERTY()
+	FString SemanticRules;
+
+	/** Index of the part of the sequence frames rendered by this job */
+	UPROPERTY()
+	int32 ShardIndex = 0;
+
+	/** Number of equal parts the sequence frames are split into */
+	UPROPERTY()
+	int32 ShardCount = 1;
+
+	/** First frame of an explicit frame range, counted from the sequence start */
+	UPROPERTY()
+	int32 FrameRangeStart = 0;
+
+	/** Frame after the last one of an explicit frame range, the range is used instead of shards if not empty */
+	UPROPERTY()
+	int32 FrameRangeEnd = 0;
+
+	/** Distance between two frames considered for rendering */
+	UPROPERTY()
+	int32 FrameStride = 1;
+
+	/** Camera translation since the last rendered frame needed to render a frame, in cm */
+	UPROPERTY()
+	float MinFrameTranslation = 0.0f;
+
+	/** Camera rotation since the last rendered frame needed to render a frame, in degrees */
+	UPROPERTY()
+	float MinFrameRotation = 0.0f;
+
+	/** Output image resolution */
+	UPROPERTY()
+	FIntPoint OutputImageResolution = FIntPoint(1920, 1080);
+
+	/** Depth target clipping range */
+	UPROPERTY()
+	float DepthRange = 100.0f;
+
+	/** Optical flow target scaling coefficient */
+	UPROPERTY()
+	float OpticalFlowScale = 1.0f;
+
+	/** Longest wait for the editor readiness before each target */
+	UPROPERTY()
+	float MaxReadinessWaitSeconds = FRendererTargetOptions::DefaultMaxReadinessWaitSecondsValue;
+
+	/** Rendering output directory */
+	UPROPERTY()
+	FString OutputDirectory;
+
+	/** Loads the job from a JSON file */
+	static bool LoadFromFile(const FString& FilePath, FEasySynthRenderJob& OutRenderJob, FString& OutErrorMessage);
+
+	/** Parses the job from a JSON string */
+	static bool LoadFromString(const FString& JsonString, FEasySynthRenderJob& OutRenderJob, FString& OutErrorMessage);
+
+	/** Converts the job into renderer target options, fails if a target or format is unknown */
+	bool ToRendererTargetOptions(FRendererTargetOptions& OutRendererTargetOptions, FString& OutErrorMessage) const;
+};
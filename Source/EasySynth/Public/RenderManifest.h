@@ -0,0 +1,143 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Async/Future.h"
+
+
+/**
+ * Class that tracks finished outputs of a rendering inside a manifest file
+ * in the output directory, so that an interrupted rendering can be resumed
+*/
+class FRenderManifest
+{
+public:
+	/**
+	 * Prepares the manifest file for the rendered part of the sequence frames
+	 * If bResume is set, outputs recorded by previous renderings into the same directory are loaded,
+	 * keeping only those that still exist with the recorded size and hash, otherwise the manifest starts empty
+	*/
+	bool Open(const FString& OutputDirectory, const int StartFrame, const int EndFrame, const bool bResume);
+
+	/**
+	 * Starts expecting outputs of the sequence frames inside the directory of a camera and target pair,
+	 * only files written from now on are recorded, so that leftovers of other renderings are never taken as finished
+	*/
+	void ExpectOutputs(const FString& CameraName, const FString& TargetName, const TArray<int>& Frames);
+
+	/**
+	 * Records expected outputs that have been written, checking only the files expected next
+	 * Unless bOutputsComplete is set, a file is recorded only once its size stops changing between scans,
+	 * otherwise all expected outputs are checked and expecting them ends
+	*/
+	void ScanOutputs(const bool bOutputsComplete);
+
+	/** Checks if the output of the sequence frame has been recorded */
+	bool Contains(const FString& CameraName, const FString& TargetName, const int Frame) const;
+
+	/** Appends recorded outputs whose hashes are computed to the manifest file, optionally waiting for all of them */
+	bool Flush(const bool bWaitForHashes = false);
+
+	/** Returns the number of recorded outputs */
+	int Num() const { return Entries.Num(); }
+
+private:
+	/** Single recorded output file */
+	struct FEntry
+	{
+		/** Path relative to the output directory */
+		FString File;
+
+		/** File size in bytes */
+		int64 Size;
+
+		/** MD5 hash of the file content */
+		FString Hash;
+	};
+
+	/** Outputs of a camera and target pair expected to be written by the current rendering */
+	struct FExpectedOutputs
+	{
+		FString CameraName;
+
+		FString TargetName;
+
+		/** Expected sequence frames, in the order they are rendered */
+		TArray<int> Frames;
+
+		/** Index of the first expected frame not yet recorded */
+		int FirstPending = 0;
+
+		/** Marks recorded frames by their indices */
+		TBitArray<> Recorded;
+
+		/** Output file name parts around the frame number, known once the first output is found */
+		bool bNameKnown = false;
+		FString NamePrefix;
+		FString NameSuffix;
+		int FrameDigits = 0;
+
+		/** Sizes of not yet recorded files found by the previous scan, by frame indices */
+		TMap<int, int64> PendingFileSizes;
+
+		/** Files last modified before this time are not written by the current rendering */
+		FDateTime ExpectedSince;
+	};
+
+	/** Output recorded while its hash is still being computed */
+	struct FPendingHash
+	{
+		/** Manifest line without the hash */
+		FString LinePrefix;
+
+		/** Key of the recorded entry */
+		FString Key;
+
+		TFuture<FString> Hash;
+	};
+
+	/** Loads the entries from a manifest file, without checking the files yet */
+	void LoadManifestFile(const FString& FilePath, TArray<TPair<FString, FEntry>>& OutEntries);
+
+	/** Learns how output files are named from a file written by the current rendering */
+	bool FindOutputName(FExpectedOutputs& Outputs) const;
+
+	/** Records the output, computing its hash in the background */
+	void RecordOutput(const FExpectedOutputs& Outputs, const int Frame, const FString& FileName, const int64 FileSize);
+
+	/** Returns the key under which an output is recorded */
+	static FString EntryKey(const FString& CameraName, const FString& TargetName, const int Frame)
+	{
+		return FString::Printf(TEXT("%s/%s/%d"), *CameraName, *TargetName, Frame);
+	}
+
+	/** Splits the output file name around its trailing frame number, returns false if there is none */
+	static bool ParseFrame(
+		const FString& FileName, int& OutFrame, FString& OutPrefix, FString& OutSuffix, int& OutFrameDigits);
+
+	/** Rendering output directory */
+	FString OutputDirectory;
+
+	/** Manifest file written by this rendering */
+	FString ManifestFilePath;
+
+	/** Recorded outputs */
+	TMap<FString, FEntry> Entries;
+
+	/** Outputs expected to be written by the current rendering */
+	TArray<FExpectedOutputs> ExpectedOutputs;
+
+	/** Recorded outputs whose hashes are not computed yet */
+	TArray<FPendingHash> PendingHashes;
+
+	/** Manifest lines not yet written to the file */
+	TArray<FString> UnflushedLines;
+
+	/** Number of expected frames checked after the last recorded one, as several frames are written at once */
+	static const int ScanLookahead;
+
+	/** Header line of the manifest file */
+	static const FString HeaderLine;
+};
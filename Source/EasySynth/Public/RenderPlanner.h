@@ -0,0 +1,102 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RendererTargets/RendererTarget.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+/** Single unit of rendering work, a target rendered through one of the rig cameras */
+struct FRenderWorkItem
+{
+	/** Index of the rig camera used for the rendering, or AllRigCameras */
+	int RigCameraId;
+
+	/** Target to be rendered */
+	TSharedPtr<FRendererTarget> Target;
+
+	/** First frame to be rendered, counted from the sequence start */
+	int StartFrame;
+
+	/** Frame after the last one to be rendered, counted from the sequence start */
+	int EndFrame;
+
+	/** Distance between two rendered frames, frames in between are skipped */
+	int FrameStep = 1;
+
+	/** Marks work items that render all rig cameras within a single job */
+	static const int AllRigCameras;
+};
+
+
+/**
+ * Class that orders rendering work so that expensive level updates,
+ * such as texture style switches, happen as rarely as possible
+*/
+class FRenderPlanner
+{
+public:
+	/**
+	 * Populates the work items with all target and rig camera combinations, each covering the frame range
+	 * If bTargetMajorOrder is set, all cameras render one target before moving to the next one,
+	 * otherwise each camera renders all targets before moving to the next camera
+	 * If bAllRigCamerasPerJob is set, each target is rendered once, by all rig cameras at the same time
+	*/
+	static void PlanWork(
+		const TArray<TSharedPtr<FRendererTarget>>& Targets,
+		const int RigCameraCount,
+		const bool bTargetMajorOrder,
+		const bool bAllRigCamerasPerJob,
+		const ETextureStyle CurrentTextureStyle,
+		const int StartFrame,
+		const int EndFrame,
+		TArray<FRenderWorkItem>& OutWorkItems);
+
+	/**
+	 * Selects frames inside the range [StartFrame, EndFrame) to be rendered, keeping every FrameStride-th frame,
+	 * and out of them only frames where the camera moved or rotated more than the thresholds since the last kept one,
+	 * camera transforms are indexed by the frame counted from the sequence start, zero thresholds are ignored
+	*/
+	static void SelectFrames(
+		const TArray<FTransform>& CameraTransforms,
+		const int StartFrame,
+		const int EndFrame,
+		const int FrameStride,
+		const float MinTranslation,
+		const float MinRotationDegrees,
+		TBitArray<>& OutSelectedFrames);
+
+	/**
+	 * Splits the work item into work items rendering the provided frames, each covering a run of evenly spaced frames,
+	 * so that each run can be rendered by a single job
+	 * Neighboring runs are merged while that renders at most JobOverheadFrames not provided frames per saved job,
+	 * returns the number of not provided frames rendered
+	*/
+	static int SplitIntoRuns(
+		const FRenderWorkItem& WorkItem,
+		const TArray<int>& Frames,
+		TArray<FRenderWorkItem>& OutWorkItems);
+
+	/** Number of frames worth rendering to save a job, as each job has to warm up the level again */
+	static const int JobOverheadFrames;
+
+private:
+	/** Orders targets by the texture style, starting with the one already applied to the level */
+	static TArray<TSharedPtr<FRendererTarget>> SortBySwitchCost(
+		const TArray<TSharedPtr<FRendererTarget>>& Targets,
+		const ETextureStyle CurrentTextureStyle);
+
+	/** Returns a run covering both runs, with the largest frame step that keeps all of their frames */
+	static FRenderWorkItem MergeRuns(const FRenderWorkItem& First, const FRenderWorkItem& Second);
+
+	/** Returns the number of frames rendered by the run */
+	static int RunFrameCount(const FRenderWorkItem& Run)
+	{
+		return (Run.EndFrame - Run.StartFrame - 1) / Run.FrameStep + 1;
+	}
+
+	/** Counts texture style switches needed to render the work items in order */
+	static int CountStyleSwitches(const TArray<FRenderWorkItem>& WorkItems, ETextureStyle CurrentTextureStyle);
+};
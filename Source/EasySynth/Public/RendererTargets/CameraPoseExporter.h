@@ -27,6 +27,21 @@ public:
 		const FString& OutputDir,
 		UCameraComponent* CameraComponent);
 
+	/**
+	 * Limits the export to frames in the range [StartFrame, EndFrame), counted from the sequence start,
+	 * which saves the poses to a partial file that is later merged with other parts
+	*/
+	void SetFrameRange(const int StartFrame, const int EndFrame);
+
+	/** Limits the export to the selected frames, counted from the sequence start */
+	void SetSelectedFrames(const TBitArray<>& Frames) { SelectedFrames = Frames; }
+
+	/** Extracts camera rig poses of all sequence frames without saving them */
+	bool ExtractRigPoses(ULevelSequence* LevelSequence, TArray<FTransform>& OutCameraTransforms);
+
+	/** Merges partial camera poses files inside the directory and its subdirectories into full ones */
+	static bool MergePartialPoses(const FString& Directory);
+
 private:
 	/** Extract camera transforms using the sequencer wrapper */
 	bool ExtractCameraTransforms(const bool bAccumulateCameraOffset);
@@ -45,4 +60,16 @@ private:
 
 	/** Frame timestamps */
 	TArray<double> Timestamps;
+
+	/** Whether only a part of the sequence frames is exported */
+	bool bPartialRange = false;
+
+	/** First exported frame */
+	int RangeStartFrame = 0;
+
+	/** Frame after the last exported one */
+	int RangeEndFrame = 0;
+
+	/** Frames to be exported, all frames are exported if empty */
+	TBitArray<> SelectedFrames;
 };
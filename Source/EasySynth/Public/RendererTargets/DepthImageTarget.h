@@ -33,6 +33,15 @@ public:
 	/** Reverts changes made to the sequence by the PrepareSequence */
 	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
 
+	/** Renders a single sample per pixel without anti-aliasing */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return SingleSampleAntiAliasing(); }
+
+	/** Creates the post process material instance with the depth range parameter set */
+	UMaterialInterface* CreatePostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None) override;
+
+	/** Writes the depth into a single full precision Z channel */
+	FEXRChannelSchemaLocal ExrChannelSchema() const override;
+
 private:
 	/** The clipping range meters when rendering the depth target */
 	const float DepthRangeMeters;
@@ -0,0 +1,43 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RendererTargets/RendererTarget.h"
+
+class UTextureStyleManager;
+
+
+/**
+ * Class responsible for updating the world properties before
+ * the instance image target rendering and restoring them after the rendering
+*/
+class FInstanceImageTarget : public FRendererTarget
+{
+public:
+	explicit FInstanceImageTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
+		FRendererTarget(TextureStyleManager, ImageFormat)
+	{}
+
+	/** Returns the name of the target */
+	virtual FString Name() const { return TEXT("InstanceImage"); }
+
+	/** Returns the texture style needed by the target */
+	ETextureStyle TextureStyle() const override { return ETextureStyle::INSTANCE; }
+
+	/** Prepares the sequence for rendering the target */
+	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+
+	/** Reverts changes made to the sequence by the PrepareSequence */
+	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+
+	/** Renders a single sample per pixel without anti-aliasing, as blending IDs would produce wrong ones */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return SingleSampleAntiAliasing(); }
+
+	/** Creates the post process material, which writes plain actor colors same as for semantic images */
+	UMaterialInterface* CreatePostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None) override;
+
+	/** Writes instance IDs into a single unsigned integer id channel */
+	FEXRChannelSchemaLocal ExrChannelSchema() const override;
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RendererTargets/RendererTarget.h"
+
+class UMaterialInterface;
+class UTextureStyleManager;
+
+
+/**
+ * Class that combines multiple renderer targets sharing the same texture style, output format
+ * and anti-aliasing settings into a single rendering job, rendering each of them
+ * as a separate post process pass of the same deferred render
+*/
+class FMultiPassImageTarget : public FRendererTarget
+{
+public:
+	explicit FMultiPassImageTarget(
+		UTextureStyleManager* TextureStyleManager,
+		const EImageFormat ImageFormat,
+		const TArray<TSharedPtr<FRendererTarget>>& Targets) :
+			FRendererTarget(TextureStyleManager, ImageFormat),
+			Targets(Targets)
+	{}
+
+	/** Returns the combined name of all contained targets */
+	virtual FString Name() const;
+
+	/** Returns output directory names of all contained targets */
+	TArray<FString> OutputNames() const override;
+
+	/** Returns the texture style shared by all contained targets */
+	ETextureStyle TextureStyle() const override { return Targets[0]->TextureStyle(); }
+
+	/** Returns anti-aliasing overrides shared by all contained targets */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return Targets[0]->AntiAliasingOverrides(); }
+
+	/** Prepares the sequence for rendering all contained targets */
+	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+
+	/** Reverts changes made to the sequence by the PrepareSequence */
+	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+
+	/** Returns post process materials of all contained targets */
+	TArray<UMaterialInterface*> PassMaterials() const override { return Materials; }
+
+	/** Returns EXR channel schemas of all contained targets, by the names of their passes */
+	TMap<FString, FEXRChannelSchemaLocal> ExrPassChannelSchemas() const override;
+
+	/** Returns EXR compressions of contained targets that override the config one, by the names of their passes */
+	TMap<FString, FEXRCompressionLocal> ExrPassCompressions() const override;
+
+	/** Returns the contained targets */
+	const TArray<TSharedPtr<FRendererTarget>>& GetTargets() const { return Targets; }
+
+private:
+	/** Releases the pass materials created by the PrepareSequence */
+	void ReleasePassMaterials();
+
+	/** Targets rendered together */
+	const TArray<TSharedPtr<FRendererTarget>> Targets;
+
+	/**
+	 * Pass materials created for the current rendering, named after their targets
+	 * Added to the root while rendering, as the movie pipeline only holds soft references to them
+	*/
+	TArray<UMaterialInterface*> Materials;
+};
@@ -28,4 +28,10 @@ public:
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
 	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+
+	/** Renders a single sample per pixel without anti-aliasing */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return SingleSampleAntiAliasing(); }
+
+	/** Writes the normal vector mapped back to the [-1, 1] range into x, y and z channels */
+	FEXRChannelSchemaLocal ExrChannelSchema() const override;
 };
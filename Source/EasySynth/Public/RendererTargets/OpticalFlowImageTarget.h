@@ -33,7 +33,22 @@ public:
 	/** Reverts changes made to the sequence by PrepareSequence */
 	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
 
+	/** Renders a single sample per pixel without anti-aliasing */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return SingleSampleAntiAliasing(); }
+
+	/**
+	 * Creates the post process material instance with the optical flow scale parameter set,
+	 * or the material that renders flow vectors themselves for EXR images
+	*/
+	UMaterialInterface* CreatePostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None) override;
+
+	/** Writes the rendered flow vector into full precision u and v channels */
+	FEXRChannelSchemaLocal ExrChannelSchema() const override;
+
 private:
+	/** Creates the post process material that renders flow vectors into the R and G channels */
+	UMaterialInterface* CreateFlowVectorMaterial(UObject* Outer, const FName ObjectName) const;
+
 	/** The scaling coefficient for increasing the saturation of optical flow images */
 	const float OpticalFlowScale;
 
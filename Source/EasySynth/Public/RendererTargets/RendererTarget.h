@@ -4,14 +4,54 @@
 
 #include "CoreMinimal.h"
 #include "IImageWrapper.h"
+#include "MoviePipelineAntiAliasingSetting.h"
 
 #include "PathUtils.h"
+#include "TextureStyles/TextureStyleManager.h"
 
 class UCameraComponent;
 class ULevelSequence;
+class UMaterialInterface;
 
 class UTextureStyleManager;
 
+struct FEXRChannelSchemaLocal;
+struct FEXRCompressionLocal;
+enum class EEXRCompressionFormatLocal : uint8;
+
+
+/**
+ * Anti-aliasing and sampling settings in which a target differs from the movie pipeline config,
+ * unset values keep the config values
+*/
+struct FAntiAliasingOverrides
+{
+	/** Number of spatial samples per frame */
+	TOptional<int32> SpatialSampleCount;
+
+	/** Number of temporal samples per frame */
+	TOptional<int32> TemporalSampleCount;
+
+	/** Anti-aliasing method overriding the project one */
+	TOptional<EAntiAliasingMethod> AntiAliasingMethod;
+
+	/** Number of engine warm-up frames before a shot */
+	TOptional<int32> EngineWarmUpCount;
+
+	/** Number of warm-up frames rendered before a shot */
+	TOptional<int32> RenderWarmUpCount;
+
+	bool operator==(const FAntiAliasingOverrides& Other) const
+	{
+		return
+			SpatialSampleCount == Other.SpatialSampleCount &&
+			TemporalSampleCount == Other.TemporalSampleCount &&
+			AntiAliasingMethod == Other.AntiAliasingMethod &&
+			EngineWarmUpCount == Other.EngineWarmUpCount &&
+			RenderWarmUpCount == Other.RenderWarmUpCount;
+	}
+};
+
 
 /**
  * Base class for renderer targets responsible for updating the
@@ -23,7 +63,10 @@ class FRendererTarget
 public:
 	explicit FRendererTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
 		ImageFormat(ImageFormat),
-		TextureStyleManager(TextureStyleManager)
+		TextureStyleManager(TextureStyleManager),
+		ResolutionScaleValue(1.0f),
+		DwaCompressionLevelValue(45.0f),
+		bAllRigCamerasValue(false)
 	{}
 
 	/** Returns a name of a specific target */
@@ -35,23 +78,109 @@ public:
 	/** Reverts changes made to the sequence by the PrepareSequence */
 	virtual bool FinalizeSequence(ULevelSequence* LevelSequence) = 0;
 
+	/** Returns names of output directories the target renders into */
+	virtual TArray<FString> OutputNames() const { return { Name() }; }
+
+	/** Returns the texture style the level needs to have while rendering the target */
+	virtual ETextureStyle TextureStyle() const { return ETextureStyle::COLOR; }
+
+	/** Returns anti-aliasing and sampling settings the target needs to differ from the config */
+	virtual FAntiAliasingOverrides AntiAliasingOverrides() const { return FAntiAliasingOverrides(); }
+
+	/** Creates the post process material that produces the target */
+	virtual UMaterialInterface* CreatePostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None)
+	{
+		return LoadPostProcessMaterial(Outer, ObjectName);
+	}
+
+	/**
+	 * Returns post process materials that should be rendered as separate passes of a single job,
+	 * empty if the target is rendered through the camera post process settings
+	*/
+	virtual TArray<UMaterialInterface*> PassMaterials() const { return TArray<UMaterialInterface*>(); }
+
+	/** Returns the channels written into EXR images of the target, no channels keep the rendered color */
+	virtual FEXRChannelSchemaLocal ExrChannelSchema() const;
+
+	/**
+	 * Returns EXR channel schemas by the names of render passes they apply to,
+	 * the empty name standing for the pass of a target rendered through the camera post process settings
+	*/
+	virtual TMap<FString, FEXRChannelSchemaLocal> ExrPassChannelSchemas() const;
+
+	/** Sets the compression of EXR images of the target, overriding the config one */
+	void SetExrCompression(const EEXRCompressionFormatLocal Compression, const float DwaCompressionLevel)
+	{
+		ExrCompressionValue = Compression;
+		DwaCompressionLevelValue = DwaCompressionLevel;
+	}
+
+	/**
+	 * Returns EXR compressions by the names of render passes they apply to, the same way as channel schemas,
+	 * empty if the target keeps the config compression
+	*/
+	virtual TMap<FString, FEXRCompressionLocal> ExrPassCompressions() const;
+
+	/** bAllRigCamerasValue setter */
+	void SetAllRigCameras(const bool bAllRigCameras) { bAllRigCamerasValue = bAllRigCameras; }
+
+	/** ResolutionScaleValue setter */
+	void SetResolutionScale(const float ResolutionScale) { ResolutionScaleValue = ResolutionScale; }
+
+	/** ResolutionScaleValue getter */
+	float ResolutionScale() const { return ResolutionScaleValue; }
+
+	/** Returns the resolution of target images, scaled from the selected output image resolution */
+	FIntPoint OutputResolution(const FIntPoint& BaseResolution) const
+	{
+		return FIntPoint(
+			FMath::Max(1, FMath::RoundToInt(BaseResolution.X * ResolutionScaleValue)),
+			FMath::Max(1, FMath::RoundToInt(BaseResolution.Y * ResolutionScaleValue)));
+	}
+
 	/** Output image format selected for this target */
 	const EImageFormat ImageFormat;
 
 protected:
-	/** Extracts camera components used by the level sequence */
+	/** Extracts camera components used by the level sequence, including all cameras of the bound rig actors */
 	TArray<UCameraComponent*> GetCameras(ULevelSequence* LevelSequence);
 
 	/** Removes renderer target specific post-process materials */
 	bool ClearCameraPostProcess(ULevelSequence* LevelSequence);
 
+	/**
+	 * Settings for targets that encode data per pixel, such as depths or class labels,
+	 * where multiple samples only blend values of neighboring pixels and waste GPU time
+	*/
+	static FAntiAliasingOverrides SingleSampleAntiAliasing()
+	{
+		FAntiAliasingOverrides Overrides;
+		Overrides.SpatialSampleCount = 1;
+		Overrides.TemporalSampleCount = 1;
+		Overrides.AntiAliasingMethod = EAntiAliasingMethod::AAM_None;
+		Overrides.RenderWarmUpCount = 0;
+		return Overrides;
+	}
+
 	/** Returns the path to the specific target post process material */
-	inline UMaterial* LoadPostProcessMaterial() const
+	inline UMaterial* LoadPostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None) const
 	{
 		return DuplicateObject<UMaterial>(
-			LoadObject<UMaterial>(nullptr, *FPathUtils::PostProcessMaterialPath(Name())), nullptr);
+			LoadObject<UMaterial>(nullptr, *FPathUtils::PostProcessMaterialPath(Name())), Outer, ObjectName);
 	}
 
 	/** Handle for managing texture style in the level */
 	UTextureStyleManager* TextureStyleManager;
+
+	/** Factor the selected output image resolution is multiplied by for this target */
+	float ResolutionScaleValue;
+
+	/** Compression of EXR images of the target, unset if the config one is kept */
+	TOptional<EEXRCompressionFormatLocal> ExrCompressionValue;
+
+	/** Compression level used if the EXR compression is DWAA or DWAB */
+	float DwaCompressionLevelValue;
+
+	/** Whether all cameras of the rig are rendered by the job, so that all of them need post process materials */
+	bool bAllRigCamerasValue;
 };
@@ -16,16 +16,42 @@ class UTextureStyleManager;
 class FSemanticImageTarget : public FRendererTarget
 {
 public:
-	explicit FSemanticImageTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
-		FRendererTarget(TextureStyleManager, ImageFormat)
+	explicit FSemanticImageTarget(
+		UTextureStyleManager* TextureStyleManager,
+		const EImageFormat ImageFormat,
+		const bool bStencilMode) :
+			FRendererTarget(TextureStyleManager, ImageFormat),
+			bStencilMode(bStencilMode)
 	{}
 
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("SemanticImage"); }
 
+	/**
+	 * Returns the texture style needed by the target,
+	 * the stencil mode keeps original materials and displays classes using the post process material
+	*/
+	ETextureStyle TextureStyle() const override
+	{
+		return bStencilMode ? ETextureStyle::COLOR : ETextureStyle::SEMANTIC;
+	}
+
 	/** Prepares the sequence for rendering the target */
 	bool PrepareSequence(ULevelSequence* LevelSequence) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
 	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+
+	/** Renders a single sample per pixel without anti-aliasing */
+	FAntiAliasingOverrides AntiAliasingOverrides() const override { return SingleSampleAntiAliasing(); }
+
+	/** Creates the post process material, which maps stencil values to class colors in the stencil mode */
+	UMaterialInterface* CreatePostProcessMaterial(UObject* Outer = nullptr, const FName ObjectName = NAME_None) override;
+
+	/** Keeps the rendered colors, but point samples their mip levels so that class colors are not blended */
+	FEXRChannelSchemaLocal ExrChannelSchema() const override;
+
+private:
+	/** Whether semantic classes are read from custom depth stencil values instead of actor materials */
+	const bool bStencilMode;
 };
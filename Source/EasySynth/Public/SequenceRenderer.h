@@ -4,9 +4,15 @@
 
 #include "CoreMinimal.h"
 
+#include "Containers/Ticker.h"
+
+#include "RenderManifest.h"
+#include "RenderPlanner.h"
 #include "RendererTargets/RendererTarget.h"
 #include "RendererTargets/ColorImageTarget.h"
 #include "RendererTargets/DepthImageTarget.h"
+#include "RendererTargets/InstanceImageTarget.h"
+#include "RendererTargets/MultiPassImageTarget.h"
 #include "RendererTargets/NormalImageTarget.h"
 #include "RendererTargets/OpticalFlowImageTarget.h"
 #include "RendererTargets/SemanticImageTarget.h"
@@ -14,6 +20,8 @@
 
 #include "SequenceRenderer.generated.h"
 
+class FCameraPoseExporter;
+class FSequencerWrapper;
 class ULevelSequence;
 class UMoviePipelineExecutorBase;
 class UMoviePipelineMasterConfig;
@@ -27,7 +35,16 @@ class FRendererTargetOptions
 {
 public:
 	/** The enum containing all supported rendering targets */
-	enum TargetType { COLOR_IMAGE, DEPTH_IMAGE, NORMAL_IMAGE, OPTICAL_FLOW_IMAGE, SEMANTIC_IMAGE, COUNT };
+	enum TargetType
+	{
+		COLOR_IMAGE,
+		DEPTH_IMAGE,
+		NORMAL_IMAGE,
+		OPTICAL_FLOW_IMAGE,
+		SEMANTIC_IMAGE,
+		INSTANCE_IMAGE,
+		COUNT
+	};
 
 	FRendererTargetOptions();
 
@@ -46,6 +63,31 @@ public:
 	/** Get selected output format for the target */
 	EImageFormat OutputFormat(const int TargetType) const { return OutputFormats[TargetType]; }
 
+	/** Set the factor the output image resolution is multiplied by for the target */
+	void SetResolutionScale(const int TargetType, const float Scale) { ResolutionScales[TargetType] = Scale; }
+
+	/** Get the factor the output image resolution is multiplied by for the target */
+	float ResolutionScale(const int TargetType) const { return ResolutionScales[TargetType]; }
+
+	/** Checks if resolution scales of all targets are valid */
+	bool ResolutionScalesValid() const;
+
+	/** Set the compression of EXR images of the target, overriding the config one */
+	void SetExrCompression(const int TargetType, const EEXRCompressionFormatLocal Compression, const float DwaCompressionLevel)
+	{
+		ExrCompressions[TargetType] = Compression;
+		DwaCompressionLevels[TargetType] = DwaCompressionLevel;
+	}
+
+	/** Checks if targets that encode IDs into colors are rendered into lossless formats */
+	bool OutputFormatsValid() const;
+
+	/** Checks if the EXR compression alters 16-bit color values */
+	static bool IsLossyExrCompression(const EEXRCompressionFormatLocal Compression);
+
+	/** Checks if the target encodes IDs into colors, so that its images need lossless compressions */
+	static bool EncodesIds(const int TargetType) { return TargetType == SEMANTIC_IMAGE || TargetType == INSTANCE_IMAGE; }
+
 	/** Updates should camera poses be exported */
 	void SetExportCameraPoses(const bool bValue) { bExportCameraPoses = bValue; }
 
@@ -64,10 +106,108 @@ public:
 	/** OpticalFlowScaleValue setter */
 	float OpticalFlowScale() const { return OpticalFlowScaleValue; }
 
-	/** Populate provided queue with selected renderer targets */
+	/** Updates should compatible targets be rendered as passes of a single job */
+	void SetSinglePassRendering(const bool bValue) { bSinglePassRendering = bValue; }
+
+	/** Returns should compatible targets be rendered as passes of a single job */
+	bool SinglePassRendering() const { return bSinglePassRendering; }
+
+	/** Updates should all cameras render a target before moving to the next target */
+	void SetTargetMajorOrder(const bool bValue) { bTargetMajorOrder = bValue; }
+
+	/** Returns should all cameras render a target before moving to the next target */
+	bool TargetMajorOrder() const { return bTargetMajorOrder; }
+
+	/** Updates should all rig cameras be rendered by a single job */
+	void SetRenderAllRigCameras(const bool bValue) { bRenderAllRigCameras = bValue; }
+
+	/** Returns should all rig cameras be rendered by a single job */
+	bool RenderAllRigCameras() const { return bRenderAllRigCameras; }
+
+	/** Updates should outputs already recorded in the output directory be skipped */
+	void SetResumeRendering(const bool bValue) { bResumeRendering = bValue; }
+
+	/** Returns should outputs already recorded in the output directory be skipped */
+	bool ResumeRendering() const { return bResumeRendering; }
+
+	/** Selects the part of the sequence frames rendered by this process, out of ShardCount equal parts */
+	void SetShard(const int ShardIndex, const int ShardCount)
+	{
+		ShardIndexValue = ShardIndex;
+		ShardCountValue = ShardCount;
+	}
+
+	/** ShardIndexValue getter */
+	int ShardIndex() const { return ShardIndexValue; }
+
+	/** ShardCountValue getter */
+	int ShardCount() const { return ShardCountValue; }
+
+	/**
+	 * Selects an explicit range [StartFrame, EndFrame) of frames to be rendered, counted from the sequence start,
+	 * which takes precedence over shards, the [0, 0) range selects all frames and other empty ranges are invalid
+	*/
+	void SetFrameRange(const int StartFrame, const int EndFrame)
+	{
+		FrameRangeStartValue = StartFrame;
+		FrameRangeEndValue = EndFrame;
+	}
+
+	/** FrameRangeStartValue getter */
+	int FrameRangeStart() const { return FrameRangeStartValue; }
+
+	/** FrameRangeEndValue getter */
+	int FrameRangeEnd() const { return FrameRangeEndValue; }
+
+	/** Updates should semantic classes be rendered through custom depth stencil values */
+	void SetSemanticStencilMode(const bool bValue) { bSemanticStencilMode = bValue; }
+
+	/** Returns should semantic classes be rendered through custom depth stencil values */
+	bool SemanticStencilMode() const { return bSemanticStencilMode; }
+
+	/** Selects that only every FrameStride-th frame is rendered */
+	void SetFrameStride(const int FrameStride) { FrameStrideValue = FrameStride; }
+
+	/** FrameStrideValue getter */
+	int FrameStride() const { return FrameStrideValue; }
+
+	/** Selects the camera movement since the last rendered frame needed for a frame to be rendered, in cm */
+	void SetMinFrameTranslation(const float MinFrameTranslation) { MinFrameTranslationValue = MinFrameTranslation; }
+
+	/** MinFrameTranslationValue getter */
+	float MinFrameTranslation() const { return MinFrameTranslationValue; }
+
+	/** Selects the camera rotation since the last rendered frame needed for a frame to be rendered, in degrees */
+	void SetMinFrameRotation(const float MinFrameRotation) { MinFrameRotationValue = MinFrameRotation; }
+
+	/** MinFrameRotationValue getter */
+	float MinFrameRotation() const { return MinFrameRotationValue; }
+
+	/** Checks if frames are selected based on the camera movement */
+	bool PoseBasedFrameSelection() const { return MinFrameTranslationValue > 0.0f || MinFrameRotationValue > 0.0f; }
+
+	/** Checks if shard, frame range and frame selection options are valid */
+	bool FrameSelectionValid() const;
+
+	/** Calculates the range [OutStartFrame, OutEndFrame) of frames to be rendered out of all sequence frames */
+	void GetRenderFrameRange(const int FrameCount, int& OutStartFrame, int& OutEndFrame) const;
+
+	/** MaxReadinessWaitSecondsValue setter */
+	void SetMaxReadinessWaitSeconds(const float MaxReadinessWaitSeconds)
+	{
+		MaxReadinessWaitSecondsValue = MaxReadinessWaitSeconds;
+	}
+
+	/** MaxReadinessWaitSecondsValue getter */
+	float MaxReadinessWaitSeconds() const { return MaxReadinessWaitSecondsValue; }
+
+	/** Populate provided array with selected renderer targets */
 	void GetSelectedTargets(
 		UTextureStyleManager* TextureStyleManager,
-		TQueue<TSharedPtr<FRendererTarget>>& OutTargetsQueue) const;
+		TArray<TSharedPtr<FRendererTarget>>& OutTargets) const;
+
+	/** Default value for the longest readiness wait, also used by the stored widget state and render jobs */
+	static const float DefaultMaxReadinessWaitSecondsValue;
 
 private:
 	/** Get the renderer target object from the target type id */
@@ -79,9 +219,39 @@ private:
 	/** Selected output formats for each target */
 	TArray<EImageFormat> OutputFormats;
 
+	/**
+	 * Factors the output image resolution is multiplied by for each target,
+	 * so that data targets can be rendered at a lower resolution than color images
+	*/
+	TArray<float> ResolutionScales;
+
+	/** Compressions of EXR images for each target, unset ones keep the config compression */
+	TArray<TOptional<EEXRCompressionFormatLocal>> ExrCompressions;
+
+	/** DWAA and DWAB compression levels for each target */
+	TArray<float> DwaCompressionLevels;
+
 	/** Whether to export camera poses */
 	bool bExportCameraPoses;
 
+	/**
+	 * Whether to render targets that share the texture style and the output format
+	 * as post process passes of a single rendering job, instead of one job per target
+	*/
+	bool bSinglePassRendering;
+
+	/**
+	 * Whether to render each target through all rig cameras before moving to the next target,
+	 * instead of rendering all targets through each camera, so that texture styles switch less often
+	*/
+	bool bTargetMajorOrder;
+
+	/**
+	 * Whether to render all rig cameras as separate views of a single job,
+	 * evaluating the sequence once for all cameras instead of once per camera
+	*/
+	bool bRenderAllRigCameras;
+
 	/**
 	 * The clipping range when rendering the depth target
 	 * Larger values provide the longer range, but also the lower granularity
@@ -94,6 +264,48 @@ private:
 	*/
 	float OpticalFlowScaleValue;
 
+	/**
+	 * Whether to continue an interrupted rendering into the same output directory,
+	 * rendering only frames missing from its render manifest
+	*/
+	bool bResumeRendering;
+
+	/**
+	 * Whether to render semantic classes through custom depth stencil values of actor primitives
+	 * and a single post process material, instead of swapping materials of all level actors
+	*/
+	bool bSemanticStencilMode;
+
+	/** Index of the part of the sequence frames rendered by this process */
+	int ShardIndexValue;
+
+	/** Number of equal parts the sequence frames are split into */
+	int ShardCountValue;
+
+	/** First frame of the explicitly selected frame range */
+	int FrameRangeStartValue;
+
+	/** Frame after the last one of the explicitly selected frame range */
+	int FrameRangeEndValue;
+
+	/** Distance between two frames considered for rendering */
+	int FrameStrideValue;
+
+	/**
+	 * Camera translation since the last rendered frame needed for a frame to be rendered,
+	 * so that near-duplicate frames of slow camera segments are skipped
+	*/
+	float MinFrameTranslationValue;
+
+	/** Camera rotation since the last rendered frame needed for a frame to be rendered */
+	float MinFrameRotationValue;
+
+	/**
+	 * The longest time to wait for shaders, assets and textures to finish
+	 * compiling and streaming before the rendering of a target starts anyway
+	*/
+	float MaxReadinessWaitSecondsValue;
+
 	/** Default value for the depth range */
 	static const float DefaultDepthRangeMetersValue;
 
@@ -117,6 +329,12 @@ public:
 	/** Sets TextureStyleManager */
 	void SetTextureStyleManager(UTextureStyleManager* Value) { TextureStyleManager = Value; }
 
+	/**
+	 * Sets the movie pipeline executor class used instead of the project default local executor,
+	 * such as the in-process executor used by commandlets or a stub executor used by tests
+	*/
+	void SetExecutorClass(TSubclassOf<UMoviePipelineExecutorBase> Value) { ExecutorClassOverride = Value; }
+
 	/** Runs sequence rendering, returns false if rendering could not start */
 	bool RenderSequence(
 		ULevelSequence* LevelSequence,
@@ -140,11 +358,47 @@ private:
 	/** Movie rendering finished handle */
 	void OnExecutorFinished(UMoviePipelineExecutorBase* InPipelineExecutor, bool bSuccess);
 
-	/** Handles finding the next rig camera to be used for rendering all requested targets */
-	void FindNextCamera();
+	/** Finds the range of sequence frames to be rendered by this process */
+	bool SelectRenderFrameRange(FSequencerWrapper& SequencerWrapper);
+
+	/** Selects frames inside the rendered range based on the frame stride and the camera movement */
+	bool SelectRenderFrames();
+
+	/** Limits the pose exporter to the rendered frames if only a part of the sequence is rendered */
+	void ApplyRenderFrameRange(FCameraPoseExporter& CameraPoseExporter) const;
+
+	/**
+	 * Queues the work items, leaving out frames that are not selected
+	 * and frames already recorded inside the render manifest when resuming
+	*/
+	void EnqueueUnfinishedWork(const TArray<FRenderWorkItem>& WorkItems);
+
+	/** Returns output directory names of the requested rig camera, or of all of them */
+	TArray<FString> RigCameraNames(const int RigCameraId) const;
+
+	/** Makes the render manifest expect outputs of the current work item */
+	void ExpectCurrentOutputs();
+
+	/** Periodically records outputs of the current work item while it is being rendered */
+	bool OnManifestFlushTick(float DeltaTime);
 
-	/** Handles finding the next target to be rendered by the current camera */
-	void FindNextTarget();
+	/** Exports poses of each rig camera */
+	bool ExportRigCameraPoses();
+
+	/**
+	 * Makes the first rig camera, which is used for rendering, take the place of the requested one,
+	 * or restores its original place if all rig cameras are requested
+	*/
+	void SelectRigCamera(const int RigCameraId);
+
+	/** Handles finding the next work item to be rendered */
+	void FindNextWorkItem();
+
+	/** Starts the rendering once the editor is ready for it, or once the readiness wait times out */
+	void CheckRenderingReadiness();
+
+	/** Checks whether shaders and assets are done compiling and texture streaming has settled */
+	bool IsReadyForRendering();
 
 	/** Runs the rendering of the currently selected target */
 	void StartRendering();
@@ -169,6 +423,10 @@ private:
 	/** Keeps current rendering options */
 	FRendererTargetOptions RendererTargetOptions;
 
+	/** Movie pipeline executor class to be used instead of the project default, if set */
+	UPROPERTY()
+	TSubclassOf<UMoviePipelineExecutorBase> ExecutorClassOverride;
+
 	/** TextureStyleManager needed to be finalize the rendering */
 	UTextureStyleManager* TextureStyleManager;
 
@@ -192,24 +450,78 @@ private:
 	/** Keeps the currently selected rig camera */
 	int CurrentRigCameraId;
 
-	/** Queue of targets to be rendered */
-	TQueue<TSharedPtr<FRendererTarget>> TargetsQueue;
+	/** Queue of target and camera combinations to be rendered */
+	TQueue<FRenderWorkItem> WorkQueue;
 
 	/** Target currently being rendered */
 	TSharedPtr<FRendererTarget> CurrentTarget;
 
+	/** First frame of the current work item, counted from the sequence start */
+	int CurrentStartFrame;
+
+	/** Frame after the last one of the current work item, counted from the sequence start */
+	int CurrentEndFrame;
+
+	/** Distance between two rendered frames of the current work item */
+	int CurrentFrameStep;
+
+	/** Keeps track of finished outputs */
+	FRenderManifest RenderManifest;
+
+	/** Handle of the ticker that flushes the render manifest during rendering */
+	FTSTicker::FDelegateHandle ManifestTickerHandle;
+
+	/** Interval between two render manifest flushes */
+	static const float ManifestFlushIntervalSeconds;
+
 	/** Output image resolution */
 	FIntPoint OutputResolution;
 
+	/** Display frame number of the sequence playback start */
+	int SequenceStartFrame;
+
+	/** Number of display frames inside the sequence playback range */
+	int SequenceFrameCount;
+
+	/** First frame to be rendered, counted from the sequence start */
+	int RenderStartFrame;
+
+	/** Frame after the last one to be rendered, counted from the sequence start */
+	int RenderEndFrame;
+
+	/** Marks frames to be rendered, counted from the sequence start */
+	TBitArray<> SelectedFrames;
+
+	/** Output file name format of the default config, extended when rendering multiple passes */
+	FString DefaultFileNameFormat;
+
+	/** Anti-aliasing settings of the default config, used by targets that do not override them */
+	FAntiAliasingOverrides DefaultAntiAliasing;
+
 	/** Currently selected output directory */
 	FString RenderingDirectory;
 
 	/** Marks if rendering is currently in process */
 	bool bCurrentlyRendering;
 
-	/** Handle for a timer needed to make a brief pause between targets */
+	/** Handle for a timer that polls the editor readiness between targets */
 	FTimerHandle RendererPauseTimerHandle;
 
+	/** Time when waiting for the editor readiness for the current target started */
+	double ReadinessWaitStartTime;
+
+	/** Interval between two editor readiness checks */
+	static const float ReadinessCheckIntervalSeconds;
+
+	/** Lowest number of resources waiting for streaming since the readiness wait started */
+	int32 LowestNumWantingResources;
+
+	/** Time when the number of resources waiting for streaming last decreased */
+	double LastStreamingProgressTime;
+
+	/** How long the number of resources waiting for streaming has to stay put for streaming to be settled */
+	static const float StreamingSettleSeconds;
+
 	/** Stores the latest error message */
 	FString ErrorMessage;
 };
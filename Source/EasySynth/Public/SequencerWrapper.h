@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 
 class ISequencer;
+class UCameraComponent;
 class ULevelSequence;
 class UMovieScene;
 class UMovieSceneCameraCutSection;
@@ -14,8 +15,10 @@ class UMovieSceneTrack;
 /**
  * Class that loads the sequencer for the given level sequence asset,
  * checks the validity of all needed components and provides access to them.
+ * Inside commandlets, which have no editor UI, bindings are instead resolved
+ * directly inside the editor world, so only cameras placed in the level are supported.
  *
- * It should be used locally during an action that requires the sequencer,
+ * It should be used locally during an action that requires the sequence,
  * as it only holds weak references to its contents.
 */
 class FSequencerWrapper
@@ -24,6 +27,9 @@ public:
 	/** Opens the requested sequence */
 	bool OpenSequence(ULevelSequence* LevelSequence);
 
+	/** Returns the reason the sequence could not be opened */
+	const FString& GetErrorMessage() const { return ErrorMessage; }
+
 	/** Access the movie scene */
 	UMovieScene* GetMovieScene()
 	{
@@ -41,14 +47,16 @@ public:
 	/** Access the movie scene cut sections */
 	TArray<UMovieSceneCameraCutSection*>& GetMovieSceneCutSections();
 
-	/** Access the sequencer */
-	ISequencer* GetSequencer()
-	{
-		check(WeakSequencer.IsValid())
-		return WeakSequencer.Pin().Get();
-	}
+	/** Finds objects bound to the sequence binding */
+	TArray<UObject*> FindBoundObjects(const FGuid& BindingGuid);
+
+	/** Finds the camera component the cut section renders through */
+	UCameraComponent* GetCutSectionCamera(UMovieSceneCameraCutSection* CutSection);
 
 private:
+	/** Opened level sequence */
+	TWeakObjectPtr<ULevelSequence> WeakLevelSequence;
+
 	/** Sequence movie scene */
 	UMovieScene* MovieScene;
 
@@ -58,6 +66,9 @@ private:
 	/** Camera track cut sections */
 	TArray<UMovieSceneCameraCutSection*> MovieSceneCutSections;
 
-	/** Level sequence editor */
+	/** Level sequence editor, not opened inside commandlets */
 	TWeakPtr<ISequencer> WeakSequencer;
+
+	/** Reason the sequence could not be opened */
+	FString ErrorMessage;
 };
@@ -0,0 +1,62 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InstanceIdManager.generated.h"
+
+class AActor;
+
+class UTextureMappingAsset;
+
+
+/**
+ * Class that assigns unique IDs to paintable actors and encodes them into colors,
+ * which are written into the custom primitive data of actor primitives and displayed by a single shared material
+*/
+UCLASS()
+class UInstanceIdManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UInstanceIdManager() : NextInstanceId(FirstInstanceId) {};
+
+	/** Assigns IDs to actors that do not have one, in the order of their GUIDs */
+	void AssignInstanceIds(const TArray<AActor*>& Actors);
+
+	/** Returns the ID of the actor, or the background ID if the actor has none */
+	uint32 FindInstanceId(const FGuid& ActorGuid) const;
+
+	/** Returns the color that encodes the actor ID, assigning the ID if needed */
+	FColor ActorColor(AActor* Actor);
+
+	/** Exports the ID, color, GUID and semantic class of actors to a CSV file */
+	bool ExportInstances(
+		const FString& OutputDir,
+		const TArray<AActor*>& Actors,
+		UTextureMappingAsset* TextureMappingAsset) const;
+
+	/** Returns the color that encodes the ID, the lowest byte being stored in the red channel */
+	static FColor InstanceColor(const uint32 InstanceId);
+
+	/** The ID of pixels that do not belong to any instance */
+	static const uint32 BackgroundInstanceId;
+
+private:
+	/** Assigns the next free ID to the actor, unless all IDs that fit into the color are taken */
+	uint32 AssignInstanceId(const FGuid& ActorGuid);
+
+	/** IDs of actors by their GUIDs, kept while the editor is running so that repeated renderings match */
+	TMap<FGuid, uint32> InstanceIds;
+
+	/** The ID assigned to the next actor */
+	uint32 NextInstanceId;
+
+	/** The first ID assigned to an actor */
+	static const uint32 FirstInstanceId;
+
+	/** The largest ID that fits into the 8-bit RGB color */
+	static const uint32 MaxInstanceId;
+};
@@ -7,6 +7,8 @@
 class UTextureMappingAsset;
 class UTextureStyleManager;
 
+struct FSemanticClass;
+
 
 /**
  * Class containing interface methods for parsing and generating
@@ -20,6 +22,18 @@ public:
 	/** Handles importing semantic classes from a CSV file */
 	FReply OnImportSemanticClassesClicked(UTextureStyleManager* TextureStyleManager);
 
+	/** Replaces existing semantic classes with ones from a CSV file, without any user interaction */
+	bool ImportSemanticClasses(
+		const FString& FilePath,
+		UTextureStyleManager* TextureStyleManager,
+		FString& OutErrorMessage);
+
+	/** Parses semantic classes from the CSV file content */
+	bool ParseSemanticClasses(
+		const FString& FileContent,
+		TArray<FSemanticClass>& OutSemanticClasses,
+		FString& OutErrorMessage);
+
 	/** Handles exporting semantic classes into a CSV file */
 	bool ExportSemanticClasses(const FString& OutputDir, UTextureMappingAsset* TextureMappingAsset);
 };
@@ -0,0 +1,155 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Internationalization/Regex.h"
+
+#include "SemanticRuleEngine.generated.h"
+
+class AActor;
+class UTextureStyleManager;
+
+
+/** Single rule that assigns a semantic class to actors whose property matches the pattern */
+USTRUCT()
+struct FSemanticRule
+{
+	GENERATED_BODY()
+
+	/** Name of the semantic class assigned to matching actors */
+	UPROPERTY()
+	FString Class;
+
+	/** Matched actor property, Label, Tag, Folder, Mesh or Component */
+	UPROPERTY()
+	FString Property;
+
+	/** How the pattern is matched, Exact, Prefix or Regex */
+	UPROPERTY()
+	FString Match = TEXT("Exact");
+
+	/** Pattern the actor property is matched against, case-sensitively for all match types */
+	UPROPERTY()
+	FString Pattern;
+};
+
+
+/** Structure representing semantic rule JSON files, earlier rules take precedence over later ones */
+USTRUCT()
+struct FSemanticRuleSet
+{
+	GENERATED_BODY()
+
+	/** Ordered semantic rules */
+	UPROPERTY()
+	TArray<FSemanticRule> Rules;
+};
+
+
+/**
+ * Class that labels level actors with semantic classes using ordered rules
+ * Rules are compiled into hash tables and prefix tries per actor property,
+ * evaluated for all level actors in parallel and applied in a single batch
+*/
+class FSemanticRuleEngine
+{
+public:
+	FSemanticRuleEngine() {}
+
+	/** Handles importing semantic rules from a JSON file and applying them to level actors */
+	FReply OnApplySemanticRulesClicked(UTextureStyleManager* TextureStyleManager);
+
+	/** Loads and compiles rules from a JSON file */
+	bool LoadRules(const FString& FilePath, FString& OutErrorMessage);
+
+	/** Compiles rules into lookup structures, replacing previously compiled ones */
+	bool CompileRules(const FSemanticRuleSet& RuleSet, FString& OutErrorMessage);
+
+	/** Assigns the class of the first matching rule to each level actor */
+	bool ApplyRules(UTextureStyleManager* TextureStyleManager, FString& OutErrorMessage) const;
+
+	/** Returns the class of the first rule that matches the actor property value, or an empty string if none does */
+	FString FindMatchingClass(const FString& PropertyName, const FString& Value) const;
+
+private:
+	/** Actor properties rules can match */
+	enum EActorProperty
+	{
+		LABEL,
+		TAG,
+		FOLDER,
+		MESH,
+		COMPONENT,
+		ACTOR_PROPERTY_COUNT
+	};
+
+	/** Hashes and compares exact rule patterns case-sensitively, the way prefix and regex rules match */
+	struct FCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
+
+	/** Node of a prefix trie, that stores the first rule whose prefix ends at the node */
+	struct FPrefixTrieNode
+	{
+		/** Indices of child nodes by their characters */
+		TMap<TCHAR, int32> Children;
+
+		/** Index of the first rule whose prefix ends at the node */
+		int32 RuleIndex = INDEX_NONE;
+	};
+
+	/** Compiled rules that match a single actor property */
+	class FPropertyMatcher
+	{
+	public:
+		FPropertyMatcher();
+
+		/** Adds a rule that matches the whole property value */
+		void AddExactRule(const FString& Pattern, const int32 RuleIndex);
+
+		/** Adds a rule that matches the beginning of the property value */
+		void AddPrefixRule(const FString& Pattern, const int32 RuleIndex);
+
+		/** Adds a rule that matches the property value using a regular expression */
+		void AddRegexRule(const FString& Pattern, const int32 RuleIndex);
+
+		/** Returns the first rule before FirstRuleIndex that matches the value, or FirstRuleIndex if none does */
+		int32 FirstMatchingRule(const FString& Value, int32 FirstRuleIndex) const;
+
+	private:
+		/** Exact match rules by their patterns */
+		TMap<FString, int32, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> ExactRules;
+
+		/** Prefix match rules, the first node is the root */
+		TArray<FPrefixTrieNode> PrefixTrie;
+
+		/** Regular expression rules, sorted by their rule indices */
+		TArray<TPair<FRegexPattern, int32>> RegexRules;
+	};
+
+	/** Property values of a single actor, collected on the game thread */
+	struct FActorProperties
+	{
+		TArray<FString> Values[ACTOR_PROPERTY_COUNT];
+	};
+
+	/** Checks if the regular expression compiles, otherwise describes the error */
+	static bool ValidateRegex(const FString& Pattern, FString& OutErrorMessage);
+
+	/** Collects the actor property values rules are matched against */
+	static void CollectActorProperties(AActor* Actor, FActorProperties& OutProperties);
+
+	/** Actor properties by their names used inside rules */
+	static const TMap<FString, EActorProperty> ActorPropertyNames;
+
+	/** Compiled rules per actor property */
+	FPropertyMatcher PropertyMatchers[ACTOR_PROPERTY_COUNT];
+
+	/** Semantic class names of rules, by their rule indices */
+	TArray<FString> RuleClassNames;
+};
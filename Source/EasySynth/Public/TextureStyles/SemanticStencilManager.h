@@ -0,0 +1,95 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SemanticStencilManager.generated.h"
+
+class APostProcessVolume;
+class UMaterial;
+class UPrimitiveComponent;
+class UTexture2D;
+
+struct FSemanticClass;
+
+
+/**
+ * Class that displays semantic classes without swapping actor materials,
+ * by writing class IDs into the custom depth stencil of actor primitives,
+ * which a single post process material maps to class colors
+*/
+UCLASS()
+class USemanticStencilManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	USemanticStencilManager() : OriginalCustomDepthMode(INDEX_NONE) {};
+
+	/**
+	 * Updates the class color lookup texture
+	 * Class IDs serve as stencil values, so painted actors stay valid while their classes exist
+	*/
+	void UpdateSemanticClasses(const TMap<uint16, FSemanticClass>& SemanticClasses);
+
+	/**
+	 * Writes the semantic class ID into the stencil of all primitives of the actor,
+	 * or zero if the ID does not fit into the stencil
+	 * Original custom depth settings of the primitives are backed up the first time they are painted
+	*/
+	void PaintActor(AActor* Actor, const uint16 ClassId);
+
+	/** Restores original custom depth settings of all painted primitives and of the renderer */
+	void RestoreOriginalStencils();
+
+	/** Returns the post process material that maps stencil values to semantic class colors */
+	UMaterial* GetPostProcessMaterial();
+
+	/** Displays semantic classes inside editor viewports, or stops displaying them */
+	void SetEditorViewEnabled(const bool bEnabled);
+
+	/** Makes the renderer write custom depth stencil values, which is disabled by default */
+	void EnableCustomDepthStencil();
+
+private:
+	/** Creates the lookup texture and the post process material that reads it */
+	bool CreatePostProcessMaterial();
+
+	/** Writes class colors into the lookup texture at the texels of their stencil values */
+	void UpdateLookupTexture();
+
+	/** Custom depth settings of a primitive before it was painted */
+	struct FStencilBackup
+	{
+		bool bRenderCustomDepth;
+
+		int32 CustomDepthStencilValue;
+	};
+
+	/** Original custom depth settings of painted primitives */
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FStencilBackup> OriginalStencils;
+
+	/** Value of the custom depth console variable before it was changed, or INDEX_NONE if it was not */
+	int32 OriginalCustomDepthMode;
+
+	/** Colors of semantic classes, indexed by their stencil values */
+	TArray<FColor> StencilColors;
+
+	/** Texture containing class colors, sampled at the texel of a stencil value */
+	UPROPERTY()
+	UTexture2D* LookupTexture;
+
+	/** Post process material that maps stencil values to class colors */
+	UPROPERTY()
+	UMaterial* PostProcessMaterial;
+
+	/** Unbound post process volume that displays semantic classes inside editor viewports */
+	TWeakObjectPtr<APostProcessVolume> EditorViewVolume;
+
+	/** Width and height of the lookup texture */
+	static const int LookupTextureSize;
+
+	/** Number of available stencil values, the zero value is left to primitives without a class */
+	static const int StencilValueCount;
+};
@@ -21,6 +21,14 @@ struct FOriginalComponentDescriptor
 	UPROPERTY()
 	TArray<UMaterialInterface*> MaterialInterfaces;
 
+	/** Original custom primitive data, stored once a color is written into it */
+	UPROPERTY()
+	TArray<float> CustomPrimitiveData;
+
+	/** Whether the original custom primitive data is stored */
+	UPROPERTY()
+	bool bCustomPrimitiveDataStored = false;
+
 	/** Wrap TArray Add method */
 	void Add(UMaterialInterface* MaterialInterface) { MaterialInterfaces.Add(MaterialInterface); }
 
@@ -80,6 +88,22 @@ public:
 	/** Removes the actor from its cache if it exists */
 	void RemoveActor(AActor* Actor);
 
+	/** Returns the material the actor is painted with, or nullptr if it displays original materials */
+	UMaterialInstanceConstant* PaintedMaterial(AActor* Actor) const;
+
+	/**
+	 * Writes the color into the custom primitive data of actor primitives, for the shared material to display it
+	 * The original data is backed up and restored together with original materials,
+	 * landscapes and actors that display original materials are ignored
+	*/
+	void PaintPrimitiveColor(AActor* Actor, const FColor& Color);
+
+	/**
+	 * Rebuilds material instances of landscapes whose proxies got a new material since the last update,
+	 * once per landscape instead of once per proxy
+	*/
+	void UpdatePendingLandscapes();
+
 private:
 	/** Sub-method of the AddAndPaint that handles landscape actors */
 	void AddLandscapeActor(
@@ -88,6 +112,9 @@ private:
 		const bool bDoPaint,
 		UMaterialInstanceConstant* Material);
 
+	/** Marks the landscape proxy for the next material instance update */
+	void AddPendingLandscapeProxy(ALandscapeProxy* LandscapeProxy);
+
 	/** Sub-method of the AddAndPaint that handles default static mesh actors */
 	void AddDefaultActor(
 		AActor* Actor,
@@ -95,6 +122,9 @@ private:
 		const bool bDoPaint,
 		UMaterialInstanceConstant* Material);
 
+	/** Replaces the custom primitive data of the primitive with the original one */
+	static void RestoreCustomPrimitiveData(UPrimitiveComponent* PrimitiveComponent, const TArray<float>& CustomPrimitiveData);
+
 	/**
 	 * Storage of the original actor materials while semantics are displayed
 	 * Mimics the behavior of the structure defined as
@@ -107,4 +137,11 @@ private:
 	/** Storage of the original landscape materials while semantics are displayed */
 	UPROPERTY()
 	TMap<ALandscapeProxy*, UMaterialInstanceConstant*> LandscapeActorDescriptors;
+
+	/** Materials currently painted over original actor materials */
+	UPROPERTY()
+	TMap<AActor*, UMaterialInstanceConstant*> PaintedMaterials;
+
+	/** Landscape proxies whose material changed, but whose material instances are not yet rebuilt */
+	TSet<TWeakObjectPtr<ALandscapeProxy>> PendingLandscapeProxies;
 };
@@ -15,6 +15,10 @@ struct FSemanticClass
 {
 	GENERATED_USTRUCT_BODY()
 
+	/** The semantic class ID, which stays the same while the class exists */
+	UPROPERTY(VisibleAnywhere, Category = "Semantic Class Properties")
+	uint16 Id;
+
 	/** The semantic class name */
 	UPROPERTY(EditAnywhere, Category = "Semantic Class Properties")
 	FString Name;
@@ -23,24 +27,101 @@ struct FSemanticClass
 	UPROPERTY(EditAnywhere, Category = "Semantic Class Properties")
 	FColor Color;
 
-	/** Reference to the plain color material instance */
-	UPROPERTY(EditAnywhere, Category = "Semantic Class Material")
+	/** Reference to the plain color material instance displayed by landscapes, created when needed */
+	UPROPERTY(Transient)
 	UMaterialInstanceConstant* PlainColorMaterialInstance;
 };
 
 
-/** An asset containing semantic mapping for each actor */
+/**
+ * An asset containing semantic mapping for each actor
+ * Classes are identified by compact IDs, while their names are only needed by the user interface
+*/
 UCLASS()
 class EASYSYNTH_API UTextureMappingAsset : public UDataAsset
 {
 	GENERATED_BODY()
 
 public:
-	/** Created semantic classes */
+	/** Migrates name based actor bindings and rebuilds lookup indices after the asset is loaded */
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	/** Rebuilds lookup indices after the asset is edited inside the asset editor */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Creates a semantic class with the lowest free ID, returns nullptr if all IDs are used */
+	FSemanticClass* AddClass(const FString& ClassName, const FColor& ClassColor);
+
+	/** Removes the semantic class, actors bound to it should be rebound beforehand */
+	void RemoveClass(const uint16 ClassId);
+
+	/** Updates the class name, which keeps its ID and actor bindings */
+	void RenameClass(const uint16 ClassId, const FString& NewClassName);
+
+	/** Returns the semantic class with the ID, or nullptr if it does not exist */
+	FSemanticClass* FindClass(const uint16 ClassId) { return SemanticClassesById.Find(ClassId); }
+
+	/** Returns the ID of the semantic class with the name, or InvalidClassId if it does not exist */
+	uint16 FindClassId(const FString& ClassName) const;
+
+	/** Returns all semantic classes by their IDs */
+	const TMap<uint16, FSemanticClass>& Classes() const { return SemanticClassesById; }
+
+	/** Returns the ID of the class bound to the actor, or InvalidClassId if the actor has no class */
+	uint16 FindActorClassId(const FGuid& ActorGuid) const;
+
+	/** Binds the actor to the semantic class, replacing its previous binding */
+	void SetActorClass(const FGuid& ActorGuid, const uint16 ClassId);
+
+	/** Removes the actor binding */
+	void RemoveActor(const FGuid& ActorGuid);
+
+	/** Returns GUIDs of actors bound to the semantic class */
+	const TSet<FGuid>& ClassActors(const uint16 ClassId) const;
+
+	/** Moves all actor bindings of a semantic class to another class */
+	void MoveClassActors(const uint16 OldClassId, const uint16 NewClassId);
+
+	/**
+	 * Redirects properties of older asset versions to the deprecated properties they are migrated from,
+	 * needs to be called before any asset is loaded
+	*/
+	static void RegisterPropertyRedirects();
+
+	/** ID that no semantic class can have */
+	static const uint16 InvalidClassId;
+
+private:
+	/** Converts class name keyed data of older asset versions to class IDs */
+	void MigrateClassNames();
+
+	/** Rebuilds the class name and class to actors indices */
+	void RebuildIndices();
+
+	/** Created semantic classes by their IDs */
 	UPROPERTY(EditAnywhere, Category = "Semantic Classes")
-	TMap<FString, FSemanticClass> SemanticClasses;
+	TMap<uint16, FSemanticClass> SemanticClassesById;
 
-	/** Actor to semantic class name bindings */
+	/**
+	 * Actor to semantic class ID bindings
+	 * Modified only through the methods above, which keep the class to actors index in sync
+	*/
 	UPROPERTY(EditAnywhere, Category = "Actor Data")
-	TMap<FGuid, FString> ActorClassPairs;
+	TMap<FGuid, uint16> ActorClassIds;
+
+	/** Semantic classes by their names, loaded from the SemanticClasses property of older asset versions */
+	UPROPERTY()
+	TMap<FString, FSemanticClass> SemanticClasses_DEPRECATED;
+
+	/** Actor to semantic class name bindings, loaded from the ActorClassPairs property of older asset versions */
+	UPROPERTY()
+	TMap<FGuid, FString> ActorClassPairs_DEPRECATED;
+
+	/** Index of class IDs by class names */
+	TMap<FString, uint16> ClassNameIds;
+
+	/** Index of actors bound to each semantic class, the inverse of ActorClassIds */
+	TMap<uint16, TSet<FGuid>> ClassActorGuids;
 };
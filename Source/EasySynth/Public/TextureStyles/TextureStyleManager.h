@@ -7,10 +7,14 @@
 #include "TextureStyleManager.generated.h"
 
 class AActor;
+class FObjectPostSaveContext;
+class FObjectPreSaveContext;
 class UMaterial;
 
 struct FSemanticClass;
+class UInstanceIdManager;
 class UMaterialInstanceConstant;
+class USemanticStencilManager;
 class UTextureBackupManager;
 class UTextureMappingAsset;
 
@@ -21,12 +25,13 @@ enum class ETextureStyle : uint8
 {
 	COLOR = 0 UMETA(DisplayName = "COLOR"),
 	SEMANTIC = 1 UMETA(DisplayName = "SEMANTIC"),
+	INSTANCE = 2 UMETA(DisplayName = "INSTANCE"),
 };
 
 
 /**
  * Class for managing mesh texture appearances,
- * such as colored and semantic views
+ * such as colored, semantic and instance views
 */
 UCLASS()
 class UTextureStyleManager : public UObject
@@ -60,6 +65,13 @@ public:
 	/** Remove all semantic classes except for the default one */
 	void RemoveAllSemanticCLasses();
 
+	/**
+	 * Replaces existing semantic classes with imported ones, validating all of them before anything changes
+	 * Existing classes with imported names keep their actors, actors of other classes get the undefined class,
+	 * which is always kept
+	*/
+	bool ImportSemanticClasses(const TArray<FSemanticClass>& ImportedClasses, FString& OutErrorMessage);
+
 	/** Returns names of existing semantic classes */
 	TArray<FString> SemanticClassNames() const;
 
@@ -69,12 +81,30 @@ public:
 	/** Applies desired class to all selected actors */
 	void ApplySemanticClassToSelectedActors(const FString& ClassName);
 
+	/**
+	 * Applies semantic classes to actors in a single batch, skipping actors that already have their class
+	 * Returns the number of actors whose class changed
+	*/
+	int ApplySemanticClassesToActors(const TMap<AActor*, FString>& ActorClassNames);
+
 	/** Update mesh materials to show requested texture styles */
 	void CheckoutTextureStyle(const ETextureStyle NewTextureStyle);
 
 	/** Get the selected texture style */
 	ETextureStyle SelectedTextureStyle() const { return CurrentTextureStyle; }
 
+	/**
+	 * Selects whether semantic classes are displayed through custom depth stencil values of actor primitives
+	 * and a single post process material, instead of swapping actor materials
+	*/
+	void SetSemanticStencilMode(const bool bEnabled);
+
+	/** Checks whether semantic classes are displayed through custom depth stencil values */
+	bool SemanticStencilMode() const { return bSemanticStencilMode; }
+
+	/** Returns the post process material that displays semantic classes in the stencil mode */
+	UMaterial* SemanticStencilMaterial();
+
 	/** Delegate type used to broadcast the semantic classes updated event */
 	DECLARE_EVENT(UTextureStyleManager, FSemanticClassesUpdatedEvent);
 
@@ -84,11 +114,20 @@ public:
 	/** Export current semantic classes to a CSV file */
 	bool ExportSemanticClasses(const FString& OutputDir);
 
+	/** Assigns instance IDs to all paintable actors and exports them to a CSV file */
+	bool ExportInstances(const FString& OutputDir);
+
+	/** Immediately saves texture mapping asset modifications that are waiting for the scheduled save */
+	void FlushTextureMappingAsset();
+
 private:
 	/** Load or create texture mapping asset on startup */
 	void LoadOrCreateTextureMappingAsset();
 
-	/** Save texture mapping asset modifications */
+	/**
+	 * Marks the texture mapping asset as modified and schedules saving it
+	 * Modifications made until the save are written together
+	*/
 	void SaveTextureMappingAsset();
 
 	/** Handles adding a new actor to the level */
@@ -100,21 +139,60 @@ private:
 	/** Handles editor closing, making sure original mesh colors are selected */
 	void OnEditorClose();
 
+	/** Handles level saving, making sure painted stencils are not saved */
+	void OnPreSaveWorld(UWorld* World, FObjectPreSaveContext ObjectSaveContext);
+
+	/** Handles level saving being done, painting stencils again */
+	void OnPostSaveWorld(UWorld* World, FObjectPostSaveContext ObjectSaveContext);
+
 	/** Sets a semantic class to the actor */
 	void SetSemanticClassToActor(
 		AActor* Actor,
-		const FString& ClassName,
+		const uint16 ClassId,
 		const bool bForceDisplaySemanticClass = false,
 		const bool bDelayAddingDescriptors = false);
 
 	/** Set active actor texture style to original or semantic color */
 	void CheckoutActorTexture(AActor* Actor, const ETextureStyle NewTextureStyle);
 
+	/** Returns the texture style actor materials need to have to display the texture style */
+	ETextureStyle MaterialTextureStyle(const ETextureStyle TextureStyle) const;
+
+	/** Writes stencil values of semantic classes into all paintable actors, assigning the default class if needed */
+	void PaintAllActorStencils();
+
+	/** Returns the ID of the undefined semantic class, assigned to actors by default */
+	uint16 UndefinedClassId() const;
+
+	/** Returns paintable actors of the current level with requested GUIDs, ignoring other actors */
+	TArray<AActor*> FindPaintableActors(const TSet<FGuid>& ActorGuids);
+
+	/** Returns all paintable actors of the current level */
+	TArray<AActor*> AllPaintableActors();
+
+	/** Rebuilds the paintable actor registry if it was built for a different world */
+	void UpdatePaintableActorsWorld();
+
+	/** Scans the current level for paintable actors */
+	void RebuildPaintableActors();
+
+	/** Checks whether the actor has primitives whose appearance the texture styles change */
+	static bool IsPaintableActor(AActor* Actor);
+
 	/** Adds semantic classes to actors in the delay actor buffer after a delay */
 	void ProcessDelayActorBuffer();
 
-	/** Generates the semantic class material if needed and returns it */
-	UMaterialInstanceConstant* GetSemanticClassMaterial(FSemanticClass& SemanticClass);
+	/**
+	 * Generates the semantic class material for landscapes if needed and returns it
+	 * Landscapes do not display custom primitive data, so they need a material instance per class
+	*/
+	UMaterialInstanceConstant* GetLandscapeClassMaterial(FSemanticClass& SemanticClass);
+
+	/**
+	 * Generates the material that displays the color written into the custom primitive data if needed and returns it
+	 * A single such material is shared by all actors
+	*/
+	UMaterialInstanceConstant* GetPrimitiveColorMaterial();
 
 	/** Semantic classes updated event dispatcher */
 	FSemanticClassesUpdatedEvent SemanticClassesUpdatedEvent;
@@ -123,10 +201,14 @@ private:
 	UPROPERTY()
 	UTextureMappingAsset* TextureMappingAsset;
 
-	/** Plain color material used for semantic mesh coloring */
+	/** Plain color material used for semantic landscape coloring and as the base of the shared material */
 	UPROPERTY()
 	UMaterial* PlainColorMaterial;
 
+	/** Material shared by all actors, that displays the color written into their custom primitive data */
+	UPROPERTY()
+	UMaterialInstanceConstant* PrimitiveColorMaterial;
+
 	/** Currently selected texture style */
 	ETextureStyle CurrentTextureStyle;
 
@@ -134,6 +216,17 @@ private:
 	UPROPERTY()
 	UTextureBackupManager* TextureBackupManager;
 
+	/** Object that manages semantic stencil values and the post process material that displays them */
+	UPROPERTY()
+	USemanticStencilManager* SemanticStencilManager;
+
+	/** Object that manages instance IDs of actors */
+	UPROPERTY()
+	UInstanceIdManager* InstanceIdManager;
+
+	/** Whether semantic classes are displayed through custom depth stencil values */
+	bool bSemanticStencilMode;
+
 	/**
 	 * Buffer used to store actors that need to have the semantic class set with a delay
 	 * This is needed when immediately setting the undefined class to just spawned actor
@@ -144,12 +237,40 @@ private:
 	/** The handle for the timer that managers DelayActorBuffer */
 	FTimerHandle DelayActorTimerHandle;
 
+	/**
+	 * Registry of level actors with primitive components or landscapes, by their GUIDs,
+	 * so that style checkouts skip other actors and class updates only touch actors of the class
+	 * Kept up to date by actor events and rebuilt once the editor world changes or a registered actor is gone
+	*/
+	TMap<FGuid, TWeakObjectPtr<AActor>> PaintableActors;
+
+	/** The world PaintableActors was built for */
+	TWeakObjectPtr<UWorld> PaintableActorsWorld;
+
+	/** Whether the texture mapping asset has modifications that are not saved */
+	bool bTextureMappingAssetDirty;
+
+	/** The handle for the timer that saves the texture mapping asset */
+	FTimerHandle SaveTimerHandle;
+
+	/** Number of save requests since the texture mapping asset was last saved */
+	int SaveRequestCount;
+
+	/** Number of texture mapping asset saves */
+	int SaveCount;
+
+	/** Total time spent on saving the texture mapping asset */
+	double TotalSaveSeconds;
+
 	/** Marks if events have already been bounded */
 	bool bEventsBound;
 
 	/** The name of the semantic color material parameter */
 	static const FString SemanticColorParameter;
 
+	/** The longest time texture mapping asset modifications wait to be saved */
+	static const float SaveIntervalSeconds;
+
 	/** The name of the Undefined semantic class */
 	static const FString UndefinedSemanticClassName;
 };
@@ -8,6 +8,7 @@
 
 #include "CameraRig/CameraRigRosInterface.h"
 #include "TextureStyles/SemanticCsvInterface.h"
+#include "TextureStyles/SemanticRuleEngine.h"
 #include "Widgets/SemanticClassesWidgetManager.h"
 
 class ULevelSequence;
@@ -90,6 +91,9 @@ private:
 	/** Interface that handles importing semantic classes from CSV */
 	FSemanticCsvInterface SemanticCsvInterface;
 
+	/** Engine that handles labelling actors using semantic rules from JSON files */
+	FSemanticRuleEngine SemanticRuleEngine;
+
 	/** Interface that handles importing camera rigs from ROS JSON files */
 	FCameraRigRosInterface CameraRigRosInterface;
 
@@ -19,6 +19,8 @@ class EASYSYNTH_API UWidgetStateAsset : public UDataAsset
 	GENERATED_BODY()
 
 public:
+	UWidgetStateAsset();
+
 	/** Selected level sequence asset */
 	UPROPERTY(EditAnywhere, Category = "Level Sequence")
 	FSoftObjectPath LevelSequenceAssetPath;
@@ -67,6 +69,58 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
 	int8 bSemanticImagesOutputFormat;
 
+	/** Whether instance images are selected */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bInstanceImagesSelected;
+
+	/** Output format for instance images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	int8 bInstanceImagesOutputFormat;
+
+	/** Output image resolution scale for color images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float ColorImagesResolutionScale = 1.0f;
+
+	/** Output image resolution scale for depth images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float DepthImagesResolutionScale = 1.0f;
+
+	/** Output image resolution scale for normal images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float NormalImagesResolutionScale = 1.0f;
+
+	/** Output image resolution scale for optical flow images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float OpticalFlowImagesResolutionScale = 1.0f;
+
+	/** Output image resolution scale for semantic images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float SemanticImagesResolutionScale = 1.0f;
+
+	/** Output image resolution scale for instance images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	float InstanceImagesResolutionScale = 1.0f;
+
+	/** Whether compatible targets are rendered as passes of a single job */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bSinglePassRenderingSelected;
+
+	/** Whether each target is rendered with all rig cameras before the next target */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bTargetMajorOrderSelected;
+
+	/** Whether all rig cameras are rendered by a single job */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bRenderAllRigCamerasSelected;
+
+	/** Whether the previous rendering into the output directory is resumed */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bResumeRenderingSelected;
+
+	/** Whether semantic classes are displayed using custom depth stencil values */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bSemanticStencilModeSelected;
+
 	/** Selected depth threashold range */
 	UPROPERTY(EditAnywhere, Category = "Additional parameters")
 	float DepthRange;
@@ -75,6 +129,22 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Additional parameters")
 	float OpticalFlowScale;
 
+	/** Selected distance between two frames considered for rendering */
+	UPROPERTY(EditAnywhere, Category = "Additional parameters")
+	int32 FrameStride = 1;
+
+	/** Selected camera translation needed to render a frame */
+	UPROPERTY(EditAnywhere, Category = "Additional parameters")
+	float MinFrameTranslation;
+
+	/** Selected camera rotation needed to render a frame */
+	UPROPERTY(EditAnywhere, Category = "Additional parameters")
+	float MinFrameRotation;
+
+	/** Selected longest wait for the editor readiness before each target */
+	UPROPERTY(EditAnywhere, Category = "Additional parameters")
+	float MaxReadinessWaitSeconds;
+
 	/** Selected output image resolution */
 	UPROPERTY(EditAnywhere, Category = "Additional parameters")
 	FIntPoint OutputImageResolution;